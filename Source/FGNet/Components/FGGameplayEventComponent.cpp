@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGGameplayEventComponent.h"
+#include "Engine/World.h"
+#include "Engine/NetConnection.h"
+#include "Engine/ActorChannel.h"
+#include "GameFramework/PlayerController.h"
+#include "../Player/FGPlayerController.h"
+#include "UObject/UObjectIterator.h"
+#include "../FGNet.h"
+
+DECLARE_STATS_GROUP(TEXT("FGGameplayEvents"), STATGROUP_FGGameplayEvents, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Queued Events"), STAT_FGQueuedGameplayEvents, STATGROUP_FGGameplayEvents);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Batches Sent"), STAT_FGGameplayEventBatchesSent, STATGROUP_FGGameplayEvents);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Reliable Bunches In Flight"), STAT_FGReliableBunchesInFlight, STATGROUP_FGGameplayEvents);
+
+bool FFGGameplayEvent::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 TypeValue = static_cast<uint32>(Type);
+	Ar.SerializeBits(&TypeValue, NumTypeBits);
+	Type = static_cast<EFGGameplayEventType>(TypeValue);
+
+	UObject* PlayerObject = Player;
+	Map->SerializeObject(Ar, AFGPlayer::StaticClass(), PlayerObject);
+	Player = Cast<AFGPlayer>(PlayerObject);
+
+	bOutSuccess = true;
+	switch (Type)
+	{
+	case EFGGameplayEventType::RocketFired:
+		FireEvent.NetSerialize(Ar, Map, bOutSuccess);
+		break;
+	case EFGGameplayEventType::RocketDetonated:
+		Ar << ShotSequence;
+		Location.NetSerialize(Ar, Map, bOutSuccess);
+		break;
+	case EFGGameplayEventType::RocketRejected:
+		Ar << ShotSequence;
+		break;
+	default:
+		Ar.SetError();
+		break;
+	}
+
+	bOutSuccess &= !Ar.IsError();
+	return true;
+}
+
+bool FFGGameplayEventBatch::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Sequence;
+
+	uint32 NumEvents = FMath::Min(static_cast<uint32>(Events.Num()), MaxEvents);
+	Ar.SerializeInt(NumEvents, MaxEvents + 1);
+
+	if (Ar.IsLoading())
+	{
+		Events.SetNum(NumEvents);
+	}
+
+	bOutSuccess = true;
+	for (uint32 Index = 0; Index < NumEvents && bOutSuccess; ++Index)
+	{
+		Events[Index].NetSerialize(Ar, Map, bOutSuccess);
+	}
+
+	bOutSuccess &= !Ar.IsError();
+	return true;
+}
+
+UFGGameplayEventComponent::UFGGameplayEventComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+	// Late in the frame, so everything the frame produced goes out together
+	PrimaryComponentTick.TickGroup = TG_PostUpdateWork;
+
+	SetIsReplicatedByDefault(true);
+}
+
+void UFGGameplayEventComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (QueuedEvents.Num() > 0)
+	{
+		Flush();
+	}
+}
+
+void UFGGameplayEventComponent::QueueEvent(const FFGGameplayEvent& Event)
+{
+	QueuedEvents.Add(Event);
+
+	Stats.NumQueuedEvents = QueuedEvents.Num();
+	Stats.MaxQueuedEvents = FMath::Max(Stats.MaxQueuedEvents, Stats.NumQueuedEvents);
+	INC_DWORD_STAT(STAT_FGQueuedGameplayEvents);
+}
+
+void UFGGameplayEventComponent::BroadcastEvent(UWorld* World, const FFGGameplayEvent& Event)
+{
+	if (Event.Player != nullptr)
+	{
+		Event.Player->HandleGameplayEvent(Event);
+	}
+
+	for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		// Connections keep their channel while they have no pawn, dead players and spectators still see rockets
+		const AFGPlayerController* PlayerController = Cast<AFGPlayerController>(Iterator->Get());
+		if (PlayerController == nullptr || PlayerController->IsLocalController())
+			continue;
+
+		PlayerController->GetGameplayEventComponent()->QueueEvent(Event);
+	}
+}
+
+void UFGGameplayEventComponent::SendEventToOwner(AFGPlayer* Player, const FFGGameplayEvent& Event)
+{
+	if (Player->IsLocallyControlled())
+	{
+		Player->HandleGameplayEvent(Event);
+	}
+	else if (const AFGPlayerController* PlayerController = Cast<AFGPlayerController>(Player->GetController()))
+	{
+		PlayerController->GetGameplayEventComponent()->QueueEvent(Event);
+	}
+}
+
+void UFGGameplayEventComponent::Flush()
+{
+	for (int32 First = 0; First < QueuedEvents.Num(); First += FFGGameplayEventBatch::MaxEvents)
+	{
+		FFGGameplayEventBatch Batch;
+		Batch.Sequence = NextBatchSequence++;
+
+		const int32 NumEvents = FMath::Min<int32>(QueuedEvents.Num() - First, FFGGameplayEventBatch::MaxEvents);
+		Batch.Events.Append(QueuedEvents.GetData() + First, NumEvents);
+		Client_ReceiveEvents(Batch);
+
+		Stats.NumEventsSent += NumEvents;
+		Stats.NumBatchesSent++;
+		INC_DWORD_STAT(STAT_FGGameplayEventBatchesSent);
+	}
+
+	QueuedEvents.Reset();
+	Stats.NumQueuedEvents = 0;
+
+	// How far the reliable stream is behind, the number this channel exists to keep down
+	const AActor* Owner = GetOwner();
+	UNetConnection* Connection = Owner->GetNetConnection();
+	const UActorChannel* Channel = Connection != nullptr ? Connection->FindActorChannelRef(Owner) : nullptr;
+	Stats.NumReliableBunchesInFlight = Channel != nullptr ? Channel->NumOutRec : 0;
+	INC_DWORD_STAT_BY(STAT_FGReliableBunchesInFlight, Stats.NumReliableBunchesInFlight);
+}
+
+void UFGGameplayEventComponent::Client_ReceiveEvents_Implementation(const FFGGameplayEventBatch& Batch)
+{
+	// Reliable RPCs arrive in order, a gap means a batch was dropped on the way (too many events for one bunch)
+	if (bHasReceivedBatch && Batch.Sequence != static_cast<uint16>(LastReceivedBatchSequence + 1))
+	{
+		UE_LOG(LogFGNet, Warning, TEXT("Gameplay event batch %d arrived after %d"), Batch.Sequence, LastReceivedBatchSequence);
+		Stats.NumSequenceGaps++;
+	}
+	LastReceivedBatchSequence = Batch.Sequence;
+	bHasReceivedBatch = true;
+
+	for (const FFGGameplayEvent& Event : Batch.Events)
+	{
+		// Players that are not relevant to this connection do not resolve, there is nothing to show for them anyway
+		if (Event.Player != nullptr)
+		{
+			Event.Player->HandleGameplayEvent(Event);
+		}
+	}
+
+	Stats.NumEventsReceived += Batch.Events.Num();
+}
+
+#if !UE_BUILD_SHIPPING
+static FAutoConsoleCommandWithWorld GameplayEventStatsCommand(
+	TEXT("FGNet.Events.Stats"),
+	TEXT("Logs queue depth, batching and reliable backlog of every gameplay event channel in the world."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (World == nullptr)
+			return;
+
+		for (TObjectIterator<UFGGameplayEventComponent> It; It; ++It)
+		{
+			if (It->GetWorld() != World)
+				continue;
+
+			const FFGGameplayEventStats Stats = It->GetStats();
+			UE_LOG(LogFGNet, Log, TEXT("%s: Queued %d (max %d), Sent %d events in %d batches, Reliable in flight %d, Received %d, Gaps %d"),
+				*GetNameSafe(It->GetOwner()), Stats.NumQueuedEvents, Stats.MaxQueuedEvents, Stats.NumEventsSent, Stats.NumBatchesSent,
+				Stats.NumReliableBunchesInFlight, Stats.NumEventsReceived, Stats.NumSequenceGaps);
+		}
+	}));
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
+#include "../Player/FGPlayer.h"
+#include "FGGameplayEventComponent.generated.h"
+
+UENUM()
+enum class EFGGameplayEventType : uint8
+{
+	RocketFired,
+	RocketDetonated,
+	RocketRejected
+};
+
+// One gameplay event, only the payload that belongs to its type is serialized.
+USTRUCT()
+struct FFGGameplayEvent
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	EFGGameplayEventType Type = EFGGameplayEventType::RocketFired;
+
+	// The player the event is about, the receiving side hands the event to it
+	UPROPERTY()
+	AFGPlayer* Player = nullptr;
+
+	// RocketFired
+	UPROPERTY()
+	FFGFireEvent FireEvent;
+
+	// RocketDetonated, RocketRejected
+	UPROPERTY()
+	uint16 ShotSequence = 0;
+
+	// RocketDetonated
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	static const uint32 NumTypeBits = 3;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FFGGameplayEvent> : public TStructOpsTypeTraitsBase2<FFGGameplayEvent>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+// Everything queued for one connection during a server frame, sent as a single reliable RPC.
+USTRUCT()
+struct FFGGameplayEventBatch
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	uint16 Sequence = 0;
+
+	UPROPERTY()
+	TArray<FFGGameplayEvent> Events;
+
+	static const uint32 MaxEvents = 64;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FFGGameplayEventBatch> : public TStructOpsTypeTraitsBase2<FFGGameplayEventBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+USTRUCT(BlueprintType)
+struct FFGGameplayEventStats
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	// Events waiting for the end of the frame right now
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumQueuedEvents = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 MaxQueuedEvents = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumEventsSent = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumBatchesSent = 0;
+
+	// Reliable bunches on the owner's actor channel that have not been acknowledged yet
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumReliableBunchesInFlight = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumEventsReceived = 0;
+
+	UPROPERTY(BlueprintReadOnly)
+	int32 NumSequenceGaps = 0;
+};
+
+/**
+ * Gameplay event channel for the connection that owns this component. The server queues events during the frame and
+ * sends everything queued in one reliable RPC at the end of it, instead of one reliable RPC per event.
+ * Lives on the player controller, so the queue and its sequence survive the connection's pawns dying and respawning.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class FGNET_API UFGGameplayEventComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UFGGameplayEventComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Server only, the event goes out with everything else queued for this connection this frame
+	void QueueEvent(const FFGGameplayEvent& Event);
+
+	// Server only, handles the event on the server and queues it for every remote connection
+	static void BroadcastEvent(UWorld* World, const FFGGameplayEvent& Event);
+
+	// Server only, handles the event on the server if the player is local there and queues it for their connection otherwise.
+	// Nothing is sent if the player no longer has a controller.
+	static void SendEventToOwner(AFGPlayer* Player, const FFGGameplayEvent& Event);
+
+	UFUNCTION(BlueprintPure, Category = Network)
+	FFGGameplayEventStats GetStats() const { return Stats; }
+
+private:
+	void Flush();
+
+	UFUNCTION(Client, Reliable)
+	void Client_ReceiveEvents(const FFGGameplayEventBatch& Batch);
+
+	UPROPERTY(Transient)
+	TArray<FFGGameplayEvent> QueuedEvents;
+
+	uint16 NextBatchSequence = 0;
+	uint16 LastReceivedBatchSequence = 0;
+	bool bHasReceivedBatch = false;
+
+	FFGGameplayEventStats Stats;
+};
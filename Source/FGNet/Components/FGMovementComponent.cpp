@@ -43,7 +43,12 @@ void UFGMovementComponent::Move(FFGFrameMovement& FrameMovement)
 
 void UFGMovementComponent::ApplyGravity()
 {
-	AccumulatedGravity += Gravity * GetWorld()->GetDeltaSeconds();
+	ApplyGravity(GetWorld()->GetDeltaSeconds());
+}
+
+void UFGMovementComponent::ApplyGravity(float DeltaTime)
+{
+	AccumulatedGravity += Gravity * DeltaTime;
 }
 
 void UFGMovementComponent::SetFacingRotation(const FRotator& InFacingRotation, float InRotationSpeed)
@@ -20,11 +20,15 @@ public:
 
 	void Move(FFGFrameMovement& FrameMovement);
 	void ApplyGravity();
+	void ApplyGravity(float DeltaTime);
 
 	UPROPERTY(EditAnywhere, Category = Movement)
 	float Gravity = 30.0f;
 
 	FVector GetGravityAsVector() const { return FVector(0.0f, 0.0f, AccumulatedGravity); }
+	float GetAccumulatedGravity() const { return AccumulatedGravity; }
+	// Restores the fall speed of an earlier state, used when rewinding to a server correction
+	void SetAccumulatedGravity(float InAccumulatedGravity) { AccumulatedGravity = InAccumulatedGravity; }
 	FRotator GetFacingRotation() const { return FacingRotationCurrent; }
 	FVector GetFacingDireciton() const { return FacingRotationCurrent.Vector(); }
 
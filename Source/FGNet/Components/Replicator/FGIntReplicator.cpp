@@ -0,0 +1,75 @@
+#include "FGIntReplicator.h"
+#include "Net/UnrealNetwork.h"
+
+void UFGIntReplicator::Tick(float DeltaTime)
+{
+	TickSmoothReplicator(*this, SmoothReplicator, DeltaTime);
+}
+
+void UFGIntReplicator::Init()
+{
+	SmoothReplicator.Init();
+}
+
+void UFGIntReplicator::SetValue(int32 InValue)
+{
+	if (!IsLocallyControlled())
+		return;
+
+	if (!SmoothReplicator.SetValue(InValue))
+		return;
+
+	SetShouldTick(true);
+	BroadcastDelegate();
+}
+
+int32 UFGIntReplicator::GetValue() const
+{
+	return SmoothReplicator.GetValue();
+}
+
+void UFGIntReplicator::BroadcastDelegate()
+{
+	if (OnValueChanged.IsBound())
+		OnValueChanged.Broadcast();
+}
+
+void UFGIntReplicator::Server_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, int32 TerminalValue)
+{
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
+		return;
+
+	Multicast_SendTerminalValue(SyncTag, Timestamp, TerminalValue);
+}
+
+void UFGIntReplicator::Server_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, int32 ReplicatedValue)
+{
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
+		return;
+
+	Multicast_SendReplicatedValue(SyncTag, Timestamp, ReplicatedValue);
+}
+
+void UFGIntReplicator::Multicast_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, int32 TerminalValue)
+{
+	if (IsLocallyControlled())
+		return;
+
+	// The server already dropped stale values when they arrived from the owner
+	if (SmoothReplicator.ReceiveTerminalValue(SyncTag, Timestamp, TerminalValue, !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
+}
+
+void UFGIntReplicator::Multicast_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, int32 ReplicatedValue)
+{
+	if (IsLocallyControlled())
+		return;
+
+	if (SmoothReplicator.ReceiveReplicatedValue(SyncTag, Timestamp, ReplicatedValue, !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
+}
+
+bool UFGIntReplicator::ShouldTick() const
+{
+	return SmoothReplicator.ShouldTick(IsLocallyControlled());
+}
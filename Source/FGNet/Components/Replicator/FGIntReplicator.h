@@ -0,0 +1,56 @@
+#pragma once
+
+#include "FGReplicatorBase.h"
+#include "FGSmoothReplicator.h"
+#include "FGIntReplicator.generated.h"
+
+// Interpolated values are rounded, the last one received is always reached exactly
+UCLASS()
+class FGNET_API UFGIntReplicator : public UFGReplicatorBase
+{
+	GENERATED_BODY()
+public:
+	void Tick(float DeltaTime);
+
+	virtual void Init() override;
+
+	UFUNCTION(Server, Reliable)
+	void Server_SendTerminalValue(int32 SyncTag, uint16 Timestamp, int32 TerminalValue);
+
+	UFUNCTION(Server, Unreliable)
+	void Server_SendReplicatedValue(int32 SyncTag, uint16 Timestamp, int32 ReplicatedValue);
+
+	UFUNCTION(NetMulticast, Reliable)
+	void Multicast_SendTerminalValue(int32 SyncTag, uint16 Timestamp, int32 TerminalValue);
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void Multicast_SendReplicatedValue(int32 SyncTag, uint16 Timestamp, int32 ReplicatedValue);
+
+	UFUNCTION(BlueprintCallable, Category = Network)
+	void SetValue(int32 InValue);
+
+	UFUNCTION(BlueprintPure, Category = Network)
+	int32 GetValue() const;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = 1))
+	int32 NumberOfReplicationsPerSecond = 5;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	EFGSmoothReplicatorMode SmoothMode = EFGSmoothReplicatorMode::ConstantVelocity;
+
+	UPROPERTY(BlueprintAssignable)
+	FFGOnSmoothValueReplicationChanged OnValueChanged;
+
+	bool ShouldTick() const;
+
+	virtual void WriteBatchedValue(FArchive& Ar) const override { WriteSmoothReplicatorValue(Ar, SmoothReplicator); }
+	virtual void ReadBatchedValue(FArchive& Ar, int32 SyncTag, uint16 Timestamp) override { ReadSmoothReplicatorValue(*this, SmoothReplicator, Ar, SyncTag, Timestamp); }
+
+protected:
+	virtual FFGReplicatorTickFunction GetTickFunction() const override { return &TickReplicatorGroup<UFGIntReplicator>; }
+
+private:
+	void BroadcastDelegate();
+
+	TFGSmoothReplicator<int32> SmoothReplicator;
+};
@@ -0,0 +1,75 @@
+#include "FGQuatReplicator.h"
+#include "Net/UnrealNetwork.h"
+
+void UFGQuatReplicator::Tick(float DeltaTime)
+{
+	TickSmoothReplicator(*this, SmoothReplicator, DeltaTime);
+}
+
+void UFGQuatReplicator::Init()
+{
+	SmoothReplicator.Init();
+}
+
+void UFGQuatReplicator::SetValue(const FQuat& InValue)
+{
+	if (!IsLocallyControlled())
+		return;
+
+	if (!SmoothReplicator.SetValue(InValue))
+		return;
+
+	SetShouldTick(true);
+	BroadcastDelegate();
+}
+
+FQuat UFGQuatReplicator::GetValue() const
+{
+	return SmoothReplicator.GetValue();
+}
+
+void UFGQuatReplicator::BroadcastDelegate()
+{
+	if (OnValueChanged.IsBound())
+		OnValueChanged.Broadcast();
+}
+
+void UFGQuatReplicator::Server_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, const FQuat& TerminalValue)
+{
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
+		return;
+
+	Multicast_SendTerminalValue(SyncTag, Timestamp, TerminalValue);
+}
+
+void UFGQuatReplicator::Server_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, const FQuat& ReplicatedValue)
+{
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
+		return;
+
+	Multicast_SendReplicatedValue(SyncTag, Timestamp, ReplicatedValue);
+}
+
+void UFGQuatReplicator::Multicast_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, const FQuat& TerminalValue)
+{
+	if (IsLocallyControlled())
+		return;
+
+	// The server already dropped stale values when they arrived from the owner
+	if (SmoothReplicator.ReceiveTerminalValue(SyncTag, Timestamp, TerminalValue, !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
+}
+
+void UFGQuatReplicator::Multicast_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, const FQuat& ReplicatedValue)
+{
+	if (IsLocallyControlled())
+		return;
+
+	if (SmoothReplicator.ReceiveReplicatedValue(SyncTag, Timestamp, ReplicatedValue, !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
+}
+
+bool UFGQuatReplicator::ShouldTick() const
+{
+	return SmoothReplicator.ShouldTick(IsLocallyControlled());
+}
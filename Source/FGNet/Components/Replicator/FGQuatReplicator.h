@@ -0,0 +1,54 @@
+#pragma once
+
+#include "FGReplicatorBase.h"
+#include "FGSmoothReplicator.h"
+#include "FGQuatReplicator.generated.h"
+
+// FQuat is not available to Blueprints, use the rotator replicator there
+UCLASS()
+class FGNET_API UFGQuatReplicator : public UFGReplicatorBase
+{
+	GENERATED_BODY()
+public:
+	void Tick(float DeltaTime);
+
+	virtual void Init() override;
+
+	UFUNCTION(Server, Reliable)
+	void Server_SendTerminalValue(int32 SyncTag, uint16 Timestamp, const FQuat& TerminalValue);
+
+	UFUNCTION(Server, Unreliable)
+	void Server_SendReplicatedValue(int32 SyncTag, uint16 Timestamp, const FQuat& ReplicatedValue);
+
+	UFUNCTION(NetMulticast, Reliable)
+	void Multicast_SendTerminalValue(int32 SyncTag, uint16 Timestamp, const FQuat& TerminalValue);
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void Multicast_SendReplicatedValue(int32 SyncTag, uint16 Timestamp, const FQuat& ReplicatedValue);
+
+	void SetValue(const FQuat& InValue);
+
+	FQuat GetValue() const;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = 1))
+	int32 NumberOfReplicationsPerSecond = 5;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	EFGSmoothReplicatorMode SmoothMode = EFGSmoothReplicatorMode::ConstantVelocity;
+
+	UPROPERTY(BlueprintAssignable)
+	FFGOnSmoothValueReplicationChanged OnValueChanged;
+
+	bool ShouldTick() const;
+
+	virtual void WriteBatchedValue(FArchive& Ar) const override { WriteSmoothReplicatorValue(Ar, SmoothReplicator); }
+	virtual void ReadBatchedValue(FArchive& Ar, int32 SyncTag, uint16 Timestamp) override { ReadSmoothReplicatorValue(*this, SmoothReplicator, Ar, SyncTag, Timestamp); }
+
+protected:
+	virtual FFGReplicatorTickFunction GetTickFunction() const override { return &TickReplicatorGroup<UFGQuatReplicator>; }
+
+private:
+	void BroadcastDelegate();
+
+	TFGSmoothReplicator<FQuat> SmoothReplicator;
+};
@@ -1,7 +1,9 @@
 #include "FGReplicatorBase.h"
 #include "GameFramework/Pawn.h"
 #include "Engine/Engine.h"
+#include "Engine/World.h"
 #include "Net/UnrealNetwork.h"
+#include "FGReplicatorSubsystem.h"
 
 // Check where should be called (Actor's server_xxx_implementation)
 int32 UFGReplicatorBase::GetFunctionCallspace(UFunction* Function, FFrame* Stack)
@@ -47,24 +49,41 @@ bool UFGReplicatorBase::IsNameStableForNetworking() const
 	return true;
 }
 
-void UFGReplicatorBase::Tick(float DeltaTime)
+void UFGReplicatorBase::BeginDestroy()
 {
+	if (TickSubsystem != nullptr)
+	{
+		TickSubsystem->RemoveAwakeReplicator(this);
+	}
 
+	Super::BeginDestroy();
 }
 
-bool UFGReplicatorBase::IsTickable() const
+void UFGReplicatorBase::SetShouldTick(bool bInShouldTick)
 {
-	return bShouldTick;
-}
+	bShouldTick = bInShouldTick;
 
-TStatId UFGReplicatorBase::GetStatId() const
-{
-	return UObject::GetStatID();
+	if (bShouldTick)
+	{
+		if (AwakeIndex != INDEX_NONE || HasAnyFlags(RF_ClassDefaultObject))
+			return;
+
+		UWorld* World = GetWorld();
+		UFGReplicatorSubsystem* ReplicatorSubsystem = World != nullptr ? World->GetSubsystem<UFGReplicatorSubsystem>() : nullptr;
+		if (ReplicatorSubsystem != nullptr)
+		{
+			ReplicatorSubsystem->AddAwakeReplicator(this);
+		}
+	}
+	else if (TickSubsystem != nullptr)
+	{
+		TickSubsystem->RemoveAwakeReplicator(this);
+	}
 }
 
-void UFGReplicatorBase::SetShouldTick(bool bInShouldTick)
+bool UFGReplicatorBase::IsTicking() const
 {
-	bShouldTick = bInShouldTick;
+	return bShouldTick;
 }
 
 bool UFGReplicatorBase::IsLocallyControlled() const
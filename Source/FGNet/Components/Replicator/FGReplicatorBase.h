@@ -1,24 +1,127 @@
+#pragma once
+
 #include "UObject/Object.h"
-#include "Tickable.h"
 #include "FGReplicatorBase.generated.h"
 
+class UFGReplicatorBase;
+class UFGReplicatorComponent;
+class UFGReplicatorSubsystem;
+
+// Ticks every awake replicator of one class, see TickReplicatorGroup
+typedef void (*FFGReplicatorTickFunction)(TArray<UFGReplicatorBase*>& Replicators, float DeltaTime);
+
 UENUM()
 enum class EFGSmoothReplicatorMode : uint8
 {
-	ConstantVelocity
+	// Straight lines between crumbs
+	ConstantVelocity,
+	// Cubic curve through the crumbs, tangents estimated from the neighbouring crumbs and the time between them
+	Hermite,
+	// Cubic curve through the crumbs assuming they are evenly spaced in time
+	CatmullRom,
+	// Follows the straight lines through a critically damped spring, rounding off the corners without overshooting
+	CriticallyDampedSpring
 };
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FFGOnSmoothValueReplicationChanged);
+
+// The higher order modes build their curves out of differences between values, Delta and Offset are inverse of each other
 template <typename ValueType>
 struct TFGSmoothReplicatorOperation
 {
+	using FDelta = ValueType;
+
+	// Engine math types do not initialize themselves
+	static ValueType Zero() { return ValueType(0); }
+	static FDelta ZeroDelta() { return FDelta(0); }
+
+	static FDelta Delta(const ValueType& From, const ValueType& To) { return To - From; }
+	static ValueType Offset(const ValueType& Value, const FDelta& Delta) { return Value + Delta; }
+
 	static void InterpConstantVelocity(ValueType& CurrentValue, const ValueType& FrameTarget, float Alpha)
 	{
 		CurrentValue = CurrentValue + (FrameTarget - CurrentValue) * Alpha;
 	}
 };
 
+// Rotators take the shortest way around instead of unwinding through every full turn between them
+template <>
+struct TFGSmoothReplicatorOperation<FRotator>
+{
+	using FDelta = FRotator;
+
+	static FRotator Zero() { return FRotator(0); }
+	static FDelta ZeroDelta() { return FRotator(0); }
+
+	static FDelta Delta(const FRotator& From, const FRotator& To) { return (To - From).GetNormalized(); }
+	static FRotator Offset(const FRotator& Value, const FDelta& Delta) { return (Value + Delta).GetNormalized(); }
+
+	static void InterpConstantVelocity(FRotator& CurrentValue, const FRotator& FrameTarget, float Alpha)
+	{
+		CurrentValue = Offset(CurrentValue, Delta(CurrentValue, FrameTarget) * Alpha);
+	}
+};
+
+// Differences between quaternions are rotation vectors, axis scaled by angle in radians
+template <>
+struct TFGSmoothReplicatorOperation<FQuat>
+{
+	using FDelta = FVector;
+
+	static FQuat Zero() { return FQuat::Identity; }
+	static FDelta ZeroDelta() { return FVector::ZeroVector; }
+
+	static FDelta Delta(const FQuat& From, const FQuat& To)
+	{
+		FQuat Difference = To * From.Inverse();
+		if (Difference.W < 0.0f)
+			Difference = Difference * -1.0f;
+
+		FVector Axis;
+		float Angle;
+		Difference.ToAxisAndAngle(Axis, Angle);
+		return Axis * Angle;
+	}
+
+	static FQuat Offset(const FQuat& Value, const FDelta& Delta)
+	{
+		return (FQuat(Delta.GetSafeNormal(), Delta.Size()) * Value).GetNormalized();
+	}
+
+	static void InterpConstantVelocity(FQuat& CurrentValue, const FQuat& FrameTarget, float Alpha)
+	{
+		CurrentValue = FQuat::Slerp(CurrentValue, FrameTarget, Alpha);
+	}
+};
+
+// Receivers move through the crumbs in FValue and only convert to the replicated type for output
+template <typename ValueType>
+struct TFGSmoothReplicatorInterpValue
+{
+	using FValue = ValueType;
+
+	static const FValue& ToInterp(const ValueType& Value) { return Value; }
+	static const ValueType& FromInterp(const FValue& Value) { return Value; }
+};
+
+// Integers are interpolated in float and rounded on output, rounding every frame would throw away any progress of less
+// than half a unit per frame and stall slow changes
+template <>
+struct TFGSmoothReplicatorInterpValue<int32>
+{
+	using FValue = float;
+
+	static FValue ToInterp(int32 Value) { return (float)Value; }
+	static int32 FromInterp(FValue Value) { return FMath::RoundToInt(Value); }
+};
+
+/**
+ * Replicators do not tick on their own. While awake they sit in a list of the replicator subsystem, one per concrete
+ * class, which ticks the whole list in one loop without a virtual call per replicator. Sleeping replicators cost
+ * nothing per frame.
+ */
 UCLASS(abstract, BlueprintType, Blueprintable)
-class FGNET_API UFGReplicatorBase : public UObject, public FTickableGameObject
+class FGNET_API UFGReplicatorBase : public UObject
 {
 	GENERATED_BODY()
 
@@ -30,21 +133,50 @@ public:
 	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
 	virtual bool IsSupportedForNetworking() const override;
 	virtual bool IsNameStableForNetworking() const override;
+	virtual void BeginDestroy() override;
 #pragma endregion
 
-#pragma region FTickableGameObject
-	virtual void Tick(float DeltaTime) override;
-	virtual bool IsTickable() const override;
-	virtual TStatId GetStatId() const override;
-#pragma endregion
-
+	// Wakes the replicator up or puts it to sleep
 	void SetShouldTick(bool bInShouldTick);
 	bool IsTicking() const;
 
 	bool IsLocallyControlled() const;
 	bool HasAuthority() const;
 
+	// Set for replicators created by a replicator component, their values are sent in the component's batches
+	UFGReplicatorComponent* GetReplicatorComponent() const { return ReplicatorComponent; }
+	int32 GetReplicatorIndex() const { return ReplicatorIndex; }
+
+	// Packs the current value into a batch, and unpacks one on the receiving side
+	virtual void WriteBatchedValue(FArchive& Ar) const {}
+	virtual void ReadBatchedValue(FArchive& Ar, int32 SyncTag, uint16 Timestamp) {}
+
+protected:
+	// Concrete replicators return TickReplicatorGroup<ThisClass>, only called when a replicator wakes up for the first time
+	virtual FFGReplicatorTickFunction GetTickFunction() const { return nullptr; }
+
 private:
+	friend class UFGReplicatorComponent;
+	friend class UFGReplicatorSubsystem;
+
+	UFGReplicatorComponent* ReplicatorComponent = nullptr;
+	int32 ReplicatorIndex = INDEX_NONE;
+
 	bool bShouldTick = false;
+
+	// Where the subsystem keeps this replicator while it is awake
+	UFGReplicatorSubsystem* TickSubsystem = nullptr;
+	int32 TickGroupIndex = INDEX_NONE;
+	int32 AwakeIndex = INDEX_NONE;
 };
 
+// Goes backwards, a replicator falling asleep swaps the last one in the list, which has already ticked, into its place
+template <typename ReplicatorType>
+void TickReplicatorGroup(TArray<UFGReplicatorBase*>& Replicators, float DeltaTime)
+{
+	for (int32 Index = Replicators.Num() - 1; Index >= 0; --Index)
+	{
+		if (Replicators.IsValidIndex(Index))
+			static_cast<ReplicatorType*>(Replicators[Index])->Tick(DeltaTime);
+	}
+}
@@ -1,6 +1,31 @@
 #include "FGReplicatorComponent.h"
 #include "Engine/ActorChannel.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
 #include "FGReplicatorBase.h"
+#include "FGReplicatorSubsystem.h"
+#include "FGSmoothReplicator.h"
+
+bool FFGReplicatorBatch::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar.SerializeIntPacked(ChangedMask);
+	Ar << SyncTag;
+	Ar << Timestamp;
+
+	Ar.SerializeInt(NumBits, MaxBits + 1);
+
+	if (Ar.IsLoading())
+	{
+		PackedValues.SetNumUninitialized(FMath::DivideAndRoundUp(NumBits, 8u));
+	}
+
+	Ar.SerializeBits(PackedValues.GetData(), NumBits);
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
 
 UFGReplicatorComponent::UFGReplicatorComponent()
 {
@@ -19,6 +44,99 @@ UFGReplicatorBase* UFGReplicatorComponent::AddReplicatorByClass(TSubclassOf<UFGR
 {
 	UFGReplicatorBase* NewReplicator = NewObject<UFGReplicatorBase>(GetOwner(), ClassType, Name);
 	NewReplicator->Init();
-	SmoothReplicators.Add(NewReplicator);
+	BindReplicator(SmoothReplicators.Add(NewReplicator));
 	return NewReplicator;
-}
\ No newline at end of file
+}
+
+void UFGReplicatorComponent::MarkReplicatorDirty(int32 ReplicatorIndex)
+{
+	if (DirtyMask == 0)
+	{
+		if (UFGReplicatorSubsystem* ReplicatorSubsystem = GetWorld()->GetSubsystem<UFGReplicatorSubsystem>())
+		{
+			ReplicatorSubsystem->AddDirtyComponent(this);
+		}
+	}
+
+	DirtyMask |= 1u << ReplicatorIndex;
+}
+
+void UFGReplicatorComponent::FlushReplicatedValues()
+{
+	if (DirtyMask == 0)
+		return;
+
+	FFGReplicatorBatch Batch;
+	Batch.SyncTag = NextSyncTag++;
+	Batch.Timestamp = MakeSmoothReplicatorTimestamp(GetWorld()->GetTimeSeconds());
+
+	FBitWriter Writer(FFGReplicatorBatch::MaxBits, true);
+	for (uint32 Mask = DirtyMask; Mask != 0; Mask &= Mask - 1)
+	{
+		const int32 ReplicatorIndex = FMath::CountTrailingZeros(Mask);
+		if (const UFGReplicatorBase* Replicator = SmoothReplicators[ReplicatorIndex])
+		{
+			Replicator->WriteBatchedValue(Writer);
+			Batch.ChangedMask |= 1u << ReplicatorIndex;
+		}
+	}
+
+	DirtyMask = 0;
+
+	if (!ensure(!Writer.IsError()))
+		return;
+
+	Batch.NumBits = Writer.GetNumBits();
+	Batch.PackedValues = *Writer.GetBuffer();
+	Server_SendReplicatedValues(Batch);
+}
+
+void UFGReplicatorComponent::Server_SendReplicatedValues_Implementation(const FFGReplicatorBatch& Batch)
+{
+	if (Batch.SyncTag < LastReceivedSyncTag)
+		return;
+
+	LastReceivedSyncTag = Batch.SyncTag;
+	Multicast_SendReplicatedValues(Batch);
+}
+
+void UFGReplicatorComponent::Multicast_SendReplicatedValues_Implementation(const FFGReplicatorBatch& Batch)
+{
+	FBitReader Reader(const_cast<uint8*>(Batch.PackedValues.GetData()), Batch.NumBits);
+	for (uint32 Mask = Batch.ChangedMask; Mask != 0 && !Reader.IsError(); Mask &= Mask - 1)
+	{
+		const int32 ReplicatorIndex = FMath::CountTrailingZeros(Mask);
+
+		// Without the replicator there is no telling how long its value is, or where the next one starts
+		UFGReplicatorBase* Replicator = SmoothReplicators.IsValidIndex(ReplicatorIndex) ? SmoothReplicators[ReplicatorIndex] : nullptr;
+		if (Replicator == nullptr)
+			return;
+
+		Replicator->ReadBatchedValue(Reader, Batch.SyncTag, Batch.Timestamp);
+	}
+}
+
+void UFGReplicatorComponent::OnRep_SmoothReplicators()
+{
+	for (int32 ReplicatorIndex = 0; ReplicatorIndex < SmoothReplicators.Num(); ++ReplicatorIndex)
+	{
+		BindReplicator(ReplicatorIndex);
+	}
+}
+
+void UFGReplicatorComponent::BindReplicator(int32 ReplicatorIndex)
+{
+	UFGReplicatorBase* Replicator = SmoothReplicators[ReplicatorIndex];
+	if (Replicator == nullptr || ReplicatorIndex >= MaxBatchedReplicators)
+		return;
+
+	Replicator->ReplicatorComponent = this;
+	Replicator->ReplicatorIndex = ReplicatorIndex;
+}
+
+void UFGReplicatorComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UFGReplicatorComponent, SmoothReplicators);
+}
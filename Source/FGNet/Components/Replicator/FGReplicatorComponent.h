@@ -5,6 +5,41 @@
 
 class UFGReplicatorBase;
 
+// The changing values of all replicators on one component for one send slot
+USTRUCT()
+struct FFGReplicatorBatch
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	// One bit per replicator index on the component, their values follow in index order
+	uint32 ChangedMask = 0;
+	int32 SyncTag = 0;
+	uint16 Timestamp = 0;
+
+	uint32 NumBits = 0;
+	TArray<uint8> PackedValues;
+
+	// A vector, rotator and quaternion each for all 32 replicators is well below this
+	static const uint32 MaxBits = 8192;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FFGReplicatorBatch> : public TStructOpsTypeTraitsBase2<FFGReplicatorBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Owns the smooth replicators of an actor. The first 32 of them do not send their values on their own, the component
+ * collects the ones that changed and sends them in a single RPC once the replicator subsystem has ticked them all.
+ * Terminal values stay separate reliable RPCs per replicator.
+ */
 UCLASS(meta = (BlueprintSpawnableComponent))
 class FGNET_API UFGReplicatorComponent : public UActorComponent
 {
@@ -23,7 +58,33 @@ public:
 		return CastChecked<ClassType>(AddReplicatorByClass(ClassType::StaticClass(), Name));
 	}
 
+	UFUNCTION(Server, Unreliable)
+	void Server_SendReplicatedValues(const FFGReplicatorBatch& Batch);
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void Multicast_SendReplicatedValues(const FFGReplicatorBatch& Batch);
+
+	// Owner only. The value of the replicator goes out with the next batch.
+	void MarkReplicatorDirty(int32 ReplicatorIndex);
+
+	// Sends the batch, if anything changed. Called by the replicator subsystem after it ticked all replicators.
+	void FlushReplicatedValues();
+
+	// Sync tag of the next batch, also used by terminal values so they are ordered against the batches
+	int32 GetNextSyncTag() const { return NextSyncTag; }
+
+	static const int32 MaxBatchedReplicators = 32;
+
 private:
-	UPROPERTY()
+	UFUNCTION()
+	void OnRep_SmoothReplicators();
+
+	void BindReplicator(int32 ReplicatorIndex);
+
+	UPROPERTY(ReplicatedUsing = OnRep_SmoothReplicators)
 	TArray<UFGReplicatorBase*> SmoothReplicators;
-};
\ No newline at end of file
+
+	uint32 DirtyMask = 0;
+	int32 NextSyncTag = 0;
+	int32 LastReceivedSyncTag = -1;
+};
@@ -0,0 +1,153 @@
+#include "FGReplicatorSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "FGReplicatorComponent.h"
+#include "../../FGNet.h"
+
+DECLARE_STATS_GROUP(TEXT("FGReplicators"), STATGROUP_FGReplicators, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Awake Replicators"), STAT_FGAwakeReplicators, STATGROUP_FGReplicators);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Replicator Batches Sent"), STAT_FGReplicatorBatchesSent, STATGROUP_FGReplicators);
+DECLARE_CYCLE_STAT(TEXT("Tick Replicators"), STAT_FGTickReplicators, STATGROUP_FGReplicators);
+
+void UFGReplicatorSubsystem::Deinitialize()
+{
+	for (FTickGroup& TickGroup : TickGroups)
+	{
+		for (UFGReplicatorBase* Replicator : TickGroup.Replicators)
+		{
+			Replicator->TickSubsystem = nullptr;
+			Replicator->AwakeIndex = INDEX_NONE;
+		}
+	}
+
+	TickGroups.Reset();
+	NumAwakeReplicators = 0;
+	DirtyComponents.Reset();
+
+	Super::Deinitialize();
+}
+
+void UFGReplicatorSubsystem::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGTickReplicators);
+
+	SET_DWORD_STAT(STAT_FGAwakeReplicators, NumAwakeReplicators);
+
+	for (int32 GroupIndex = 0; GroupIndex < TickGroups.Num(); ++GroupIndex)
+	{
+		FTickGroup& TickGroup = TickGroups[GroupIndex];
+		if (TickGroup.Replicators.Num() > 0)
+		{
+			TickGroup.TickFunction(TickGroup.Replicators, DeltaTime);
+		}
+	}
+
+	for (const TWeakObjectPtr<UFGReplicatorComponent>& DirtyComponent : DirtyComponents)
+	{
+		if (UFGReplicatorComponent* ReplicatorComponent = DirtyComponent.Get())
+		{
+			ReplicatorComponent->FlushReplicatedValues();
+			INC_DWORD_STAT(STAT_FGReplicatorBatchesSent);
+		}
+	}
+
+	DirtyComponents.Reset();
+}
+
+bool UFGReplicatorSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->IsGameWorld() && NumAwakeReplicators > 0;
+}
+
+TStatId UFGReplicatorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFGReplicatorSubsystem, STATGROUP_Tickables);
+}
+
+void UFGReplicatorSubsystem::AddAwakeReplicator(UFGReplicatorBase* Replicator)
+{
+	if (Replicator->AwakeIndex != INDEX_NONE)
+		return;
+
+	if (Replicator->TickGroupIndex == INDEX_NONE)
+	{
+		Replicator->TickGroupIndex = FindOrAddTickGroup(Replicator);
+		if (Replicator->TickGroupIndex == INDEX_NONE)
+			return;
+	}
+
+	TArray<UFGReplicatorBase*>& Replicators = TickGroups[Replicator->TickGroupIndex].Replicators;
+	Replicator->AwakeIndex = Replicators.Add(Replicator);
+	Replicator->TickSubsystem = this;
+	NumAwakeReplicators++;
+}
+
+void UFGReplicatorSubsystem::RemoveAwakeReplicator(UFGReplicatorBase* Replicator)
+{
+	if (Replicator->AwakeIndex == INDEX_NONE)
+		return;
+
+	TArray<UFGReplicatorBase*>& Replicators = TickGroups[Replicator->TickGroupIndex].Replicators;
+	const int32 AwakeIndex = Replicator->AwakeIndex;
+
+	Replicators.RemoveAtSwap(AwakeIndex, 1, false);
+	if (Replicators.IsValidIndex(AwakeIndex))
+	{
+		Replicators[AwakeIndex]->AwakeIndex = AwakeIndex;
+	}
+
+	Replicator->AwakeIndex = INDEX_NONE;
+	Replicator->TickSubsystem = nullptr;
+	NumAwakeReplicators--;
+}
+
+void UFGReplicatorSubsystem::AddDirtyComponent(UFGReplicatorComponent* ReplicatorComponent)
+{
+	DirtyComponents.Add(ReplicatorComponent);
+}
+
+int32 UFGReplicatorSubsystem::FindOrAddTickGroup(const UFGReplicatorBase* Replicator)
+{
+	const FFGReplicatorTickFunction TickFunction = Replicator->GetTickFunction();
+	if (!ensureMsgf(TickFunction != nullptr, TEXT("%s does not return a tick function and will never tick"), *Replicator->GetClass()->GetName()))
+		return INDEX_NONE;
+
+	for (int32 GroupIndex = 0; GroupIndex < TickGroups.Num(); ++GroupIndex)
+	{
+		if (TickGroups[GroupIndex].TickFunction == TickFunction)
+			return GroupIndex;
+	}
+
+	FTickGroup* TickGroup = new FTickGroup();
+	TickGroup->TickFunction = TickFunction;
+	TickGroup->ClassName = Replicator->GetClass()->GetFName();
+	return TickGroups.Add(TickGroup);
+}
+
+void UFGReplicatorSubsystem::LogTickGroups() const
+{
+	UE_LOG(LogFGNet, Log, TEXT("%d replicators awake in %d groups"), NumAwakeReplicators, TickGroups.Num());
+
+	for (const FTickGroup& TickGroup : TickGroups)
+	{
+		UE_LOG(LogFGNet, Log, TEXT("  %s: %d awake"), *TickGroup.ClassName.ToString(), TickGroup.Replicators.Num());
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+// FGNet.Replicators.Stats
+static FAutoConsoleCommandWithWorld ReplicatorStatsCommand(
+	TEXT("FGNet.Replicators.Stats"),
+	TEXT("Logs how many smooth replicators of each class are awake in the world."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (World == nullptr)
+			return;
+
+		if (const UFGReplicatorSubsystem* ReplicatorSubsystem = World->GetSubsystem<UFGReplicatorSubsystem>())
+		{
+			ReplicatorSubsystem->LogTickGroups();
+		}
+	}));
+#endif // !UE_BUILD_SHIPPING
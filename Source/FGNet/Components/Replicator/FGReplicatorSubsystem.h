@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Containers/IndirectArray.h"
+#include "FGReplicatorBase.h"
+#include "FGReplicatorSubsystem.generated.h"
+
+class UFGReplicatorComponent;
+
+/**
+ * Ticks every awake smooth replicator in the world. Replicators join when they wake up and leave when they fall
+ * asleep, and are kept in one dense list per concrete class so each list is ticked by a single non-virtual loop.
+ * Once all of them have ticked, every replicator component with changed values sends them in one batch.
+ */
+UCLASS()
+class FGNET_API UFGReplicatorSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+#pragma region FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+#pragma endregion
+
+	void AddAwakeReplicator(UFGReplicatorBase* Replicator);
+	void RemoveAwakeReplicator(UFGReplicatorBase* Replicator);
+
+	// Flushed at the end of the tick
+	void AddDirtyComponent(UFGReplicatorComponent* ReplicatorComponent);
+
+	int32 GetNumAwakeReplicators() const { return NumAwakeReplicators; }
+
+	// Logs how many replicators of each class are awake
+	void LogTickGroups() const;
+
+private:
+	struct FTickGroup
+	{
+		FFGReplicatorTickFunction TickFunction = nullptr;
+		// Class of the first replicator that joined, for logging
+		FName ClassName;
+		TArray<UFGReplicatorBase*> Replicators;
+	};
+
+	int32 FindOrAddTickGroup(const UFGReplicatorBase* Replicator);
+
+	// Indirect so a group keeps its address when a replicator of a new class wakes up in the middle of a tick
+	TIndirectArray<FTickGroup> TickGroups;
+	int32 NumAwakeReplicators = 0;
+
+	TArray<TWeakObjectPtr<UFGReplicatorComponent>> DirtyComponents;
+};
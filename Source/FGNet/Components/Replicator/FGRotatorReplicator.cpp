@@ -0,0 +1,75 @@
+#include "FGRotatorReplicator.h"
+#include "Net/UnrealNetwork.h"
+
+void UFGRotatorReplicator::Tick(float DeltaTime)
+{
+	TickSmoothReplicator(*this, SmoothReplicator, DeltaTime);
+}
+
+void UFGRotatorReplicator::Init()
+{
+	SmoothReplicator.Init();
+}
+
+void UFGRotatorReplicator::SetValue(const FRotator& InValue)
+{
+	if (!IsLocallyControlled())
+		return;
+
+	if (!SmoothReplicator.SetValue(InValue))
+		return;
+
+	SetShouldTick(true);
+	BroadcastDelegate();
+}
+
+FRotator UFGRotatorReplicator::GetValue() const
+{
+	return SmoothReplicator.GetValue();
+}
+
+void UFGRotatorReplicator::BroadcastDelegate()
+{
+	if (OnValueChanged.IsBound())
+		OnValueChanged.Broadcast();
+}
+
+void UFGRotatorReplicator::Server_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, const FRotator& TerminalValue)
+{
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
+		return;
+
+	Multicast_SendTerminalValue(SyncTag, Timestamp, TerminalValue);
+}
+
+void UFGRotatorReplicator::Server_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, const FRotator& ReplicatedValue)
+{
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
+		return;
+
+	Multicast_SendReplicatedValue(SyncTag, Timestamp, ReplicatedValue);
+}
+
+void UFGRotatorReplicator::Multicast_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, const FRotator& TerminalValue)
+{
+	if (IsLocallyControlled())
+		return;
+
+	// The server already dropped stale values when they arrived from the owner
+	if (SmoothReplicator.ReceiveTerminalValue(SyncTag, Timestamp, TerminalValue, !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
+}
+
+void UFGRotatorReplicator::Multicast_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, const FRotator& ReplicatedValue)
+{
+	if (IsLocallyControlled())
+		return;
+
+	if (SmoothReplicator.ReceiveReplicatedValue(SyncTag, Timestamp, ReplicatedValue, !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
+}
+
+bool UFGRotatorReplicator::ShouldTick() const
+{
+	return SmoothReplicator.ShouldTick(IsLocallyControlled());
+}
@@ -0,0 +1,525 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "FGReplicatorBase.h"
+#include "FGReplicatorComponent.h"
+
+// Owner world time in milliseconds, wrapping every 65 seconds. Receivers only ever look at the difference between two.
+inline uint16 MakeSmoothReplicatorTimestamp(double Time)
+{
+	return (uint16)((int64)(Time * 1000.0) & 0xFFFF);
+}
+
+// How each value type goes over the wire. The UObject wrappers declare their RPC parameters with FNetType.
+template <typename ValueType>
+struct TFGSmoothReplicatorNetTraits
+{
+	// float and int32 as they are
+	using FNetType = ValueType;
+
+	static const FNetType& ToNet(const ValueType& Value) { return Value; }
+	static const ValueType& FromNet(const FNetType& NetValue) { return NetValue; }
+
+	// The same encoding as the RPC parameter, for values packed into a replicator component's batch
+	static void Serialize(FArchive& Ar, ValueType& Value) { Ar << Value; }
+};
+
+template <>
+struct TFGSmoothReplicatorNetTraits<FVector>
+{
+	// Two decimals is well below anything visible
+	using FNetType = FVector_NetQuantize100;
+
+	static FNetType ToNet(const FVector& Value) { return FNetType(Value); }
+	static FVector FromNet(const FNetType& NetValue) { return NetValue; }
+
+	static void Serialize(FArchive& Ar, FVector& Value)
+	{
+		bool bSuccess = true;
+		FNetType NetValue(Value);
+		NetValue.NetSerialize(Ar, nullptr, bSuccess);
+		Value = NetValue;
+	}
+};
+
+template <>
+struct TFGSmoothReplicatorNetTraits<FRotator>
+{
+	using FNetType = FRotator;
+
+	static const FNetType& ToNet(const FRotator& Value) { return Value; }
+	static const FRotator& FromNet(const FNetType& NetValue) { return NetValue; }
+
+	static void Serialize(FArchive& Ar, FRotator& Value) { Value.SerializeCompressedShort(Ar); }
+};
+
+template <>
+struct TFGSmoothReplicatorNetTraits<FQuat>
+{
+	using FNetType = FQuat;
+
+	static const FNetType& ToNet(const FQuat& Value) { return Value; }
+	static const FQuat& FromNet(const FNetType& NetValue) { return NetValue; }
+
+	static void Serialize(FArchive& Ar, FQuat& Value)
+	{
+		bool bSuccess = true;
+		Value.NetSerialize(Ar, nullptr, bSuccess);
+	}
+};
+
+/**
+ * Owner side: sends the value a fixed number of times per second while it changes, then once more reliably when it
+ * has stopped changing. Everyone else: keeps the received values as a trail of crumbs and moves through them at the
+ * send rate, speeding up or slowing down to keep about one crumb in hand.
+ *
+ * Every value is sent with the owner's clock in milliseconds, so each crumb lasts as long as the owner actually took
+ * between sending it and the one before, no matter how jittery its arrival was. Sends happen on multiples of the
+ * crumb duration in world time, so all replicators on an actor with the same rate send in the same frame.
+ */
+template <typename ValueType>
+class TFGSmoothReplicator
+{
+public:
+	using FInterp = TFGSmoothReplicatorInterpValue<ValueType>;
+	using FInterpValue = typename FInterp::FValue;
+	using FOperation = TFGSmoothReplicatorOperation<FInterpValue>;
+	using FDelta = typename FOperation::FDelta;
+
+	enum class ESendType : uint8
+	{
+		None,
+		Replicated,
+		Terminal
+	};
+
+	void Init()
+	{
+		bIsSleeping = true;
+		bHasSentTerminalValue = true;
+		bHasReceivedTerminalValue = true;
+	}
+
+	// Owner only. Returns false if the value did not change.
+	bool SetValue(const ValueType& InValue)
+	{
+		if (InValue == ReplicatedValueCurrent)
+			return false;
+
+		ReplicatedValueCurrent = InValue;
+		InterpolatedValue = FInterp::ToInterp(InValue);
+
+		if (bIsSleeping)
+		{
+			bIsSleeping = false;
+			bHasSentTerminalValue = false;
+			// Send the first value right away instead of waiting for the next send slot
+			LastSendSlot = INDEX_NONE;
+		}
+
+		return true;
+	}
+
+	const ValueType& GetValue() const { return ReplicatedValueCurrent; }
+
+	// Owner only. Returns what has to be sent to the server this frame, with OutSyncTag and OutTimestamp.
+	ESendType TickSender(float DeltaTime, float CrumbDuration, double Time, int32& OutSyncTag, uint16& OutTimestamp)
+	{
+		bool bIsTerminal = false;
+		if (!(ReplicatedValueCurrent == ReplicatedValuePreviouslySent))
+		{
+			StaticValueTimer = 0.0f;
+		}
+		else
+		{
+			StaticValueTimer += DeltaTime;
+			if (StaticValueTimer >= SleepAfterDuration)
+				bIsTerminal = true;
+		}
+
+		ESendType SendType = ESendType::None;
+
+		const int64 SendSlot = (int64)FMath::FloorToDouble(Time / CrumbDuration);
+		if (SendSlot != LastSendSlot)
+		{
+			if (bIsTerminal)
+			{
+				if (!bHasSentTerminalValue)
+				{
+					SendType = ESendType::Terminal;
+					OutSyncTag = NextSyncTag++;
+					bHasSentTerminalValue = true;
+				}
+			}
+			else
+			{
+				SendType = ESendType::Replicated;
+				OutSyncTag = NextSyncTag++;
+				bHasSentTerminalValue = false;
+			}
+
+			LastSendSlot = SendSlot;
+			ReplicatedValuePreviouslySent = ReplicatedValueCurrent;
+			OutTimestamp = MakeSmoothReplicatorTimestamp(Time);
+		}
+
+		return SendType;
+	}
+
+	void TickReceiver(float DeltaTime, float CrumbDuration, EFGSmoothReplicatorMode SmoothMode)
+	{
+		if (NumCrumbs == 0)
+			return;
+
+		const float TrailLength = TrailDuration - CurrentCrumbElapsed;
+		float LerpSpeed = 1.0f;
+
+		// If we are getting close to the end of the trail we slow down consumption
+		if (TrailLength < CrumbDuration * 0.5f && !bHasReceivedTerminalValue)
+		{
+			LerpSpeed *= TrailLength / (CrumbDuration * 0.5f);
+		}
+		// If the crumb trail is getting too big we should increase consumption
+		else if (TrailLength > CrumbDuration * 2.5f)
+		{
+			LerpSpeed *= (TrailLength / (CrumbDuration * 2.5f));
+		}
+
+		FInterpValue FrameTarget = InterpolatedValue;
+		float FrameTargetFuture = 0.0f;
+
+		float RemainingLerp = LerpSpeed * DeltaTime;
+		while (NumCrumbs > 0 && RemainingLerp > 0.001f)
+		{
+			const FCrumb& Crumb = GetCrumb(0);
+			const float CrumbSize = Crumb.Duration - CurrentCrumbElapsed;
+			const float ConsumeLerp = FMath::Min(CrumbSize, RemainingLerp);
+
+			RemainingLerp -= ConsumeLerp;
+			CurrentCrumbElapsed += ConsumeLerp;
+
+			FrameTarget = Crumb.Value;
+			if (CrumbSize - ConsumeLerp <= 0.001f)
+			{
+				FrameTargetFuture = 0.0f;
+				PopCrumb();
+			}
+			else
+			{
+				FrameTargetFuture = CrumbSize - ConsumeLerp;
+			}
+		}
+
+		if (SmoothMode != EFGSmoothReplicatorMode::ConstantVelocity)
+		{
+			TickCurve(DeltaTime * LerpSpeed, CrumbDuration, SmoothMode);
+		}
+		// Crumbs consumed whole this frame are reached exactly, otherwise move part of the way towards the current one
+		else if (FrameTargetFuture == 0.0f)
+		{
+			InterpolatedValue = FrameTarget;
+		}
+		else
+		{
+			const float AdvanceTime = (LerpSpeed * DeltaTime) - RemainingLerp;
+			const float TimeToTarget = FrameTargetFuture + AdvanceTime;
+
+			const float Alpha = FMath::Clamp(AdvanceTime / TimeToTarget, 0.0f, 1.0f);
+			FOperation::InterpConstantVelocity(InterpolatedValue, FrameTarget, Alpha);
+		}
+
+		ReplicatedValueCurrent = FInterp::FromInterp(InterpolatedValue);
+	}
+
+	// Server only, drops values older than one already received from the owner
+	bool AcceptSyncTag(int32 SyncTag)
+	{
+		if (SyncTag < LastReceivedSyncTag)
+			return false;
+
+		LastReceivedSyncTag = SyncTag;
+		return true;
+	}
+
+	// bCheckSyncTag is false on the server, which already checked the tag when the value arrived from the owner
+	bool ReceiveTerminalValue(int32 SyncTag, uint16 Timestamp, const ValueType& TerminalValue, bool bCheckSyncTag, int32 NumberOfReplicationsPerSecond)
+	{
+		if (bCheckSyncTag && SyncTag < LastReceivedSyncTag)
+			return false;
+
+		LastReceivedSyncTag = SyncTag;
+		bHasReceivedTerminalValue = true;
+
+		PushCrumb(FInterp::ToInterp(TerminalValue), GetCrumbDuration(Timestamp, 1.0f / (float)NumberOfReplicationsPerSecond), NumberOfReplicationsPerSecond * 2);
+
+		// The owner goes to sleep after this, whatever it sends next is not timed relative to it
+		bHasPreviousTimestamp = false;
+		return true;
+	}
+
+	bool ReceiveReplicatedValue(int32 SyncTag, uint16 Timestamp, const ValueType& ReplicatedValue, bool bCheckSyncTag, int32 NumberOfReplicationsPerSecond)
+	{
+		if (bCheckSyncTag && SyncTag < LastReceivedSyncTag)
+			return false;
+
+		const float CrumbDuration = 1.0f / (float)NumberOfReplicationsPerSecond;
+		const int32 MaxCrumbs = NumberOfReplicationsPerSecond * 2;
+
+		if (bHasReceivedTerminalValue)
+		{
+			// Hold the current value for a crumb before moving, so there is something in hand when the owner wakes up
+			if (NumCrumbs == 0)
+			{
+				ResetSegment(CrumbDuration);
+				PushCrumb(InterpolatedValue, CrumbDuration, MaxCrumbs);
+			}
+		}
+
+		LastReceivedSyncTag = SyncTag;
+		bHasReceivedTerminalValue = false;
+
+		PushCrumb(FInterp::ToInterp(ReplicatedValue), GetCrumbDuration(Timestamp, CrumbDuration), MaxCrumbs);
+		return true;
+	}
+
+	bool ShouldTick(bool bIsLocallyControlled) const
+	{
+		if (bIsLocallyControlled)
+			return !bHasSentTerminalValue;
+
+		return !(bHasReceivedTerminalValue && NumCrumbs == 0);
+	}
+
+	void Sleep() { bIsSleeping = true; }
+	bool IsSleeping() const { return bIsSleeping; }
+
+private:
+	// Enough for two seconds at 16 replications per second, higher rates keep less than two seconds
+	static constexpr int32 CrumbCapacity = 32;
+	static_assert((CrumbCapacity & (CrumbCapacity - 1)) == 0, "Crumb capacity has to be a power of two");
+
+	struct FCrumb
+	{
+		FInterpValue Value;
+		// Time it takes to move from the previous crumb to this one
+		float Duration;
+	};
+
+	FCrumb& GetCrumb(int32 Offset) { return Crumbs[(CrumbHead + Offset) & (CrumbCapacity - 1)]; }
+
+	void PushCrumb(const FInterpValue& Value, float Duration, int32 MaxCrumbs)
+	{
+		FCrumb& Crumb = GetCrumb(NumCrumbs++);
+		Crumb.Value = Value;
+		Crumb.Duration = Duration;
+		TrailDuration += Duration;
+
+		if (NumCrumbs >= FMath::Min(MaxCrumbs, CrumbCapacity))
+			PopCrumb();
+	}
+
+	void PopCrumb()
+	{
+		const FCrumb& Crumb = GetCrumb(0);
+		SegmentPrevious = SegmentStart;
+		SegmentStart = Crumb.Value;
+		PreviousSegmentDuration = Crumb.Duration;
+
+		TrailDuration -= Crumb.Duration;
+		CurrentCrumbElapsed = 0.0f;
+		CrumbHead = (CrumbHead + 1) & (CrumbCapacity - 1);
+
+		if (--NumCrumbs == 0)
+			TrailDuration = 0.0f;
+	}
+
+	void ResetSegment(float CrumbDuration)
+	{
+		SegmentStart = InterpolatedValue;
+		SegmentPrevious = InterpolatedValue;
+		PreviousSegmentDuration = CrumbDuration;
+		SpringVelocity = FOperation::ZeroDelta();
+	}
+
+	// Places the value on a curve through the crumb before the current segment, the segment itself and the crumb after it
+	void TickCurve(float DeltaTime, float CrumbDuration, EFGSmoothReplicatorMode SmoothMode)
+	{
+		if (NumCrumbs == 0)
+		{
+			InterpolatedValue = SegmentStart;
+			SpringVelocity = FOperation::ZeroDelta();
+			return;
+		}
+
+		const FCrumb& Front = GetCrumb(0);
+		const FCrumb& Next = GetCrumb(NumCrumbs > 1 ? 1 : 0);
+
+		const float SegmentDuration = FMath::Max(Front.Duration, KINDA_SMALL_NUMBER);
+		const float Alpha = FMath::Clamp(CurrentCrumbElapsed / SegmentDuration, 0.0f, 1.0f);
+
+		// Everything relative to the start of the segment
+		const FDelta ToPrevious = FOperation::Delta(SegmentStart, SegmentPrevious);
+		const FDelta ToEnd = FOperation::Delta(SegmentStart, Front.Value);
+		const FDelta EndToNext = FOperation::Delta(Front.Value, Next.Value);
+
+		if (SmoothMode == EFGSmoothReplicatorMode::CriticallyDampedSpring)
+		{
+			const FInterpValue LinearTarget = FOperation::Offset(SegmentStart, ToEnd * Alpha);
+			InterpolatedValue = SpringTowards(InterpolatedValue, LinearTarget, CrumbDuration * 0.5f, DeltaTime);
+			return;
+		}
+
+		FDelta StartTangent;
+		FDelta EndTangent;
+		if (SmoothMode == EFGSmoothReplicatorMode::Hermite)
+		{
+			// Average velocity on either side of each crumb, scaled to the length of this segment
+			const float PreviousDuration = FMath::Max(PreviousSegmentDuration, KINDA_SMALL_NUMBER);
+			const float NextDuration = FMath::Max(NumCrumbs > 1 ? Next.Duration : SegmentDuration, KINDA_SMALL_NUMBER);
+
+			StartTangent = (ToPrevious * (-1.0f / PreviousDuration) + ToEnd * (1.0f / SegmentDuration)) * (0.5f * SegmentDuration);
+			EndTangent = (ToEnd * (1.0f / SegmentDuration) + EndToNext * (1.0f / NextDuration)) * (0.5f * SegmentDuration);
+		}
+		else
+		{
+			StartTangent = (ToEnd - ToPrevious) * 0.5f;
+			EndTangent = (ToEnd + EndToNext) * 0.5f;
+		}
+
+		const float Alpha2 = Alpha * Alpha;
+		const float Alpha3 = Alpha2 * Alpha;
+		const float StartTangentWeight = Alpha3 - 2.0f * Alpha2 + Alpha;
+		const float EndWeight = -2.0f * Alpha3 + 3.0f * Alpha2;
+		const float EndTangentWeight = Alpha3 - Alpha2;
+
+		InterpolatedValue = FOperation::Offset(SegmentStart, StartTangent * StartTangentWeight + ToEnd * EndWeight + EndTangent * EndTangentWeight);
+	}
+
+	// Critically damped spring after Game Programming Gems 4, 1.10
+	FInterpValue SpringTowards(const FInterpValue& Current, const FInterpValue& Target, float SmoothTime, float DeltaTime)
+	{
+		const float Omega = 2.0f / FMath::Max(SmoothTime, KINDA_SMALL_NUMBER);
+		const float X = Omega * DeltaTime;
+		const float Exp = 1.0f / (1.0f + X + 0.48f * X * X + 0.235f * X * X * X);
+
+		const FDelta Change = FOperation::Delta(Target, Current);
+		const FDelta Temp = (SpringVelocity + Change * Omega) * DeltaTime;
+		SpringVelocity = (SpringVelocity - Temp * Omega) * Exp;
+		return FOperation::Offset(Target, (Change + Temp) * Exp);
+	}
+
+	float GetCrumbDuration(uint16 Timestamp, float CrumbDuration)
+	{
+		float Duration = CrumbDuration;
+		if (bHasPreviousTimestamp)
+		{
+			// Wraps every 65 seconds, values older than the previous one have already been dropped by their sync tag
+			const uint16 DeltaMilliseconds = Timestamp - PreviousTimestamp;
+			Duration = FMath::Min((float)DeltaMilliseconds / 1000.0f, CrumbDuration * 2.0f);
+		}
+
+		PreviousTimestamp = Timestamp;
+		bHasPreviousTimestamp = true;
+		return Duration;
+	}
+
+	FCrumb Crumbs[CrumbCapacity];
+	int32 CrumbHead = 0;
+	int32 NumCrumbs = 0;
+	float TrailDuration = 0.0f;
+	float CurrentCrumbElapsed = 0.0f;
+
+	// The higher order modes remember the last two crumbs they passed
+	FInterpValue SegmentStart = FOperation::Zero();
+	FInterpValue SegmentPrevious = FOperation::Zero();
+	float PreviousSegmentDuration = 0.0f;
+	FDelta SpringVelocity = FOperation::ZeroDelta();
+
+	uint16 PreviousTimestamp = 0;
+	bool bHasPreviousTimestamp = false;
+
+	// Unrounded value receivers move, so sub-unit progress of integers carries over to the next frame
+	FInterpValue InterpolatedValue = FOperation::Zero();
+
+	ValueType ReplicatedValueCurrent = FInterp::FromInterp(FOperation::Zero());
+	ValueType ReplicatedValuePreviouslySent = FInterp::FromInterp(FOperation::Zero());
+	float StaticValueTimer = 0.0f;
+	float SleepAfterDuration = 1.0f;
+	int32 NextSyncTag = 0;
+	int32 LastReceivedSyncTag = -1;
+
+	int64 LastSendSlot = INDEX_NONE;
+
+	bool bHasReceivedTerminalValue = false;
+	bool bHasSentTerminalValue = false;
+	bool bIsSleeping = false;
+};
+
+// Everything the UObject wrappers have in common, they only differ in the value type of their RPCs.
+template <typename ReplicatorType, typename ValueType>
+void TickSmoothReplicator(ReplicatorType& Replicator, TFGSmoothReplicator<ValueType>& SmoothReplicator, float DeltaTime)
+{
+	using FNetTraits = TFGSmoothReplicatorNetTraits<ValueType>;
+
+	const float CrumbDuration = 1.0f / (float)Replicator.NumberOfReplicationsPerSecond;
+	const bool bIsLocallyControlled = Replicator.IsLocallyControlled();
+
+	if (bIsLocallyControlled)
+	{
+		// Replicators on a component share its sync tags, their values go out together in its batch
+		UFGReplicatorComponent* ReplicatorComponent = Replicator.GetReplicatorComponent();
+
+		int32 SyncTag = 0;
+		uint16 Timestamp = 0;
+		switch (SmoothReplicator.TickSender(DeltaTime, CrumbDuration, Replicator.GetWorld()->GetTimeSeconds(), SyncTag, Timestamp))
+		{
+		case TFGSmoothReplicator<ValueType>::ESendType::Terminal:
+			if (ReplicatorComponent != nullptr)
+				SyncTag = ReplicatorComponent->GetNextSyncTag();
+
+			Replicator.Server_SendTerminalValue(SyncTag, Timestamp, FNetTraits::ToNet(SmoothReplicator.GetValue()));
+			break;
+		case TFGSmoothReplicator<ValueType>::ESendType::Replicated:
+			if (ReplicatorComponent != nullptr)
+				ReplicatorComponent->MarkReplicatorDirty(Replicator.GetReplicatorIndex());
+			else
+				Replicator.Server_SendReplicatedValue(SyncTag, Timestamp, FNetTraits::ToNet(SmoothReplicator.GetValue()));
+			break;
+		default:
+			break;
+		}
+	}
+	else
+	{
+		SmoothReplicator.TickReceiver(DeltaTime, CrumbDuration, Replicator.SmoothMode);
+	}
+
+	if (!SmoothReplicator.ShouldTick(bIsLocallyControlled))
+	{
+		Replicator.SetShouldTick(false);
+		SmoothReplicator.Sleep();
+	}
+}
+
+template <typename ValueType>
+void WriteSmoothReplicatorValue(FArchive& Ar, const TFGSmoothReplicator<ValueType>& SmoothReplicator)
+{
+	ValueType Value = SmoothReplicator.GetValue();
+	TFGSmoothReplicatorNetTraits<ValueType>::Serialize(Ar, Value);
+}
+
+// Always reads the value, even if it is not used, so the values after it can be read
+template <typename ReplicatorType, typename ValueType>
+void ReadSmoothReplicatorValue(ReplicatorType& Replicator, TFGSmoothReplicator<ValueType>& SmoothReplicator, FArchive& Ar, int32 SyncTag, uint16 Timestamp)
+{
+	ValueType Value = TFGSmoothReplicatorOperation<ValueType>::Zero();
+	TFGSmoothReplicatorNetTraits<ValueType>::Serialize(Ar, Value);
+
+	if (Ar.IsError() || Replicator.IsLocallyControlled())
+		return;
+
+	// Batches skip the owner side check of the server, so every receiver checks the sync tag itself
+	if (SmoothReplicator.ReceiveReplicatedValue(SyncTag, Timestamp, Value, true, Replicator.NumberOfReplicationsPerSecond))
+		Replicator.SetShouldTick(true);
+}
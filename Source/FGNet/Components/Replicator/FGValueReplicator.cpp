@@ -3,152 +3,29 @@
 
 void UFGValueReplicator::Tick(float DeltaTime)
 {
-	const float CrumbDuration = (1.0f / (float)NumberOfReplicationsPerSecond);
-
-	if (IsLocallyControlled())
-	{
-		bool bIsTerminal = false;
-		if (ReplicatedValueCurrent != ReplicatedValuePreviouslySent)
-		{
-			StaticValueTimer = 0.0f;
-		}
-		else
-		{
-			StaticValueTimer += DeltaTime;
-			if (StaticValueTimer >= SleepAfterDuration)
-				bIsTerminal = true;
-		}
-
-		SyncTimer -= DeltaTime;
-		if (SyncTimer <= 0.0f)
-		{
-			if (bIsTerminal)
-			{
-				if (!bHasSentTerminalValue)
-				{
-					Server_SendTerminalValue(NextSyncTag++, ReplicatedValueCurrent);
-					bHasSentTerminalValue = true;
-				}
-			}
-			else
-			{
-				Server_SendReplicatedValue(NextSyncTag++, ReplicatedValueCurrent);
-				bHasSentTerminalValue = false;
-			}
-
-			SyncTimer += CrumbDuration;
-			ReplicatedValuePreviouslySent = ReplicatedValueCurrent;
-		}
-	}
-	else
-	{
-		if (CrumbTrail.Num() != 0)
-		{
-			const float TrailLength = (CrumbDuration * (float)CrumbTrail.Num()) - (CrumbDuration - CurrentCrumbTimeRemaining);
-			LerpSpeed = 1.0f;
-
-			// If we are getting close to the end of the trail we slow down consumption
-			if (TrailLength < CrumbDuration * 0.5f && !bHasReceivedTerminalValue)
-			{
-				LerpSpeed *= TrailLength / (CrumbDuration * 0.5f);
-			}
-			// If the crumb trail is getting too big we should increase consumption
-			else if (TrailLength > CrumbDuration * 2.5f)
-			{
-				LerpSpeed *= (TrailLength / (CrumbDuration * 2.5f));
-			}
-
-			float FrameTarget = ReplicatedValueCurrent;
-			float FrameTargetFuture = 0.0f;
-
-			float RemainingLerp = LerpSpeed * DeltaTime;
-			while(CrumbTrail.Num() > 0 && RemainingLerp > 0.001f)
-			{
-				float ConsumeLerp = FMath::Min(CurrentCrumbTimeRemaining, RemainingLerp);
-				float CrumbSize = CurrentCrumbTimeRemaining;
-
-				RemainingLerp -= ConsumeLerp;
-				CurrentCrumbTimeRemaining -= ConsumeLerp;
-
-				if (CurrentCrumbTimeRemaining <= 0.001f)
-				{
-					FrameTarget = CrumbTrail[0].Value;
-					FrameTargetFuture = 0.0f;
-
-					CrumbTrail.RemoveAt(0);
-					CurrentCrumbTimeRemaining = CrumbDuration;
-				}
-				else
-				{
-					FrameTarget = CrumbTrail[0].Value;
-					FrameTargetFuture = CrumbSize - ConsumeLerp;
-				}
-			}
-
-			if (FrameTarget != ReplicatedValueCurrent)
-			{
-				if (FrameTargetFuture == 0.0f)
-				{
-					ReplicatedValueCurrent = FrameTarget;
-				}
-			}
-			else
-			{
-				const float AdvanceTime = (LerpSpeed * DeltaTime) - RemainingLerp;
-				const float TimeToTarget = FrameTargetFuture + AdvanceTime;
-
-				if (SmoothMode == EFGSmoothReplicatorMode::ConstantVelocity)
-				{
-					const float Alpha = FMath::Clamp(AdvanceTime / TimeToTarget, 0.0f, 1.0f);
-					TFGSmoothReplicatorOperation<float>::InterpConstantVelocity(ReplicatedValueCurrent, FrameTarget, Alpha);
-					
-				}
-			}
-		}
-	}
-
-	if (!ShouldTick())
-	{
-		SetShouldTick(false);
-		bIsSleeping = true;
-	}
+	TickSmoothReplicator(*this, SmoothReplicator, DeltaTime);
 }
 
 void UFGValueReplicator::Init()
 {
-	bIsSleeping = true;
-	bHasSentTerminalValue = true;
-	bHasReceivedTerminalValue = true;
+	SmoothReplicator.Init();
 }
 
 void UFGValueReplicator::SetValue(float InValue)
-
 {
-	if (InValue == ReplicatedValueCurrent)
-		return;
-
 	if (!IsLocallyControlled())
 		return;
 
-	if (bIsSleeping) // it is not ticking
-	{
-		ReplicatedValueCurrent = InValue;
-		SetShouldTick(true);
-		bIsSleeping = false;
-		bHasSentTerminalValue = false;
-		SyncTimer = 0.0f;
-	}
-	else
-	{
-		ReplicatedValueCurrent = InValue;
-	}
+	if (!SmoothReplicator.SetValue(InValue))
+		return;
 
+	SetShouldTick(true);
 	BroadcastDelegate();
 }
 
 float UFGValueReplicator::GetValue() const
 {
-	return ReplicatedValueCurrent;
+	return SmoothReplicator.GetValue();
 }
 
 void UFGValueReplicator::BroadcastDelegate()
@@ -157,82 +34,42 @@ void UFGValueReplicator::BroadcastDelegate()
 		OnValueChanged.Broadcast();
 }
 
-void UFGValueReplicator::Server_SendTerminalValue_Implementation(int32 SyncTag, float TerminalValue)
+void UFGValueReplicator::Server_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, float TerminalValue)
 {
-	if (SyncTag < LastReceivedSyncTag)
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
 		return;
 
-	LastReceivedSyncTag = SyncTag;
-	Multicast_SendTerminalValue(SyncTag, TerminalValue);
+	Multicast_SendTerminalValue(SyncTag, Timestamp, TerminalValue);
 }
 
-void UFGValueReplicator::Server_SendReplicatedValue_Implementation(int32 SyncTag, float ReplicatedValue)
+void UFGValueReplicator::Server_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, float ReplicatedValue)
 {
-	if (SyncTag < LastReceivedSyncTag)
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
 		return;
 
-	LastReceivedSyncTag = SyncTag;
-	Multicast_SendReplicatedValue(SyncTag, ReplicatedValue);
+	Multicast_SendReplicatedValue(SyncTag, Timestamp, ReplicatedValue);
 }
 
-void UFGValueReplicator::Multicast_SendTerminalValue_Implementation(int32 SyncTag, float TerminalValue)
+void UFGValueReplicator::Multicast_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, float TerminalValue)
 {
 	if (IsLocallyControlled())
 		return;
 
-	if (!HasAuthority() && SyncTag < LastReceivedSyncTag)
-		return;
-
-	LastReceivedSyncTag = SyncTag;
-	bHasReceivedTerminalValue = true;
-
-	auto& Crumb = CrumbTrail.Emplace_GetRef();
-	Crumb.Value = TerminalValue;
-
-	SetShouldTick(true);
+	// The server already dropped stale values when they arrived from the owner
+	if (SmoothReplicator.ReceiveTerminalValue(SyncTag, Timestamp, TerminalValue, !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
 }
 
-void UFGValueReplicator::Multicast_SendReplicatedValue_Implementation(int32 SyncTag, float ReplicatedValue)
+void UFGValueReplicator::Multicast_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, float ReplicatedValue)
 {
 	if (IsLocallyControlled())
 		return;
 
-	if (!HasAuthority() && SyncTag < LastReceivedSyncTag)
-		return;
-
-	if (bHasReceivedTerminalValue)
-	{
-		if (CrumbTrail.Num() == 0)
-		{
-			auto& WaitCrumb = CrumbTrail.Emplace_GetRef();
-			WaitCrumb.Value = ReplicatedValueCurrent;
-		}
-	}
-
-	LastReceivedSyncTag = SyncTag;
-	bHasReceivedTerminalValue = false;
-
-	auto& Crumb = CrumbTrail.Emplace_GetRef();
-	Crumb.Value = ReplicatedValue;
-
-	if (CrumbTrail.Num() >= NumberOfReplicationsPerSecond * 2)
-		CrumbTrail.RemoveAt(0, 1, false);
-
-	SetShouldTick(true);
+	if (SmoothReplicator.ReceiveReplicatedValue(SyncTag, Timestamp, ReplicatedValue, !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
 }
 
 bool UFGValueReplicator::ShouldTick() const
 {
-	if (IsLocallyControlled())
-	{
-		if (bHasSentTerminalValue)
-			return false;
-	}
-	else
-	{
-		if (bHasReceivedTerminalValue && CrumbTrail.Num() == 0)
-			return false;
-	}
-
-	return true;
+	return SmoothReplicator.ShouldTick(IsLocallyControlled());
 }
\ No newline at end of file
@@ -1,28 +1,29 @@
+#pragma once
+
 #include "FGReplicatorBase.h"
+#include "FGSmoothReplicator.h"
 #include "FGValueReplicator.generated.h"
 
-DECLARE_DYNAMIC_MULTICAST_DELEGATE(FFGOnSmoothValueReplicationChanged);
-
 UCLASS()
 class FGNET_API UFGValueReplicator : public UFGReplicatorBase
 {
 	GENERATED_BODY()
 public:
-	virtual void Tick(float DeltaTime) override;
+	void Tick(float DeltaTime);
 
 	virtual void Init() override;
 
 	UFUNCTION(Server, Reliable)
-	void Server_SendTerminalValue(int32 SyncTag, float TerminalValue);
+	void Server_SendTerminalValue(int32 SyncTag, uint16 Timestamp, float TerminalValue);
 
 	UFUNCTION(Server, Unreliable)
-	void Server_SendReplicatedValue(int32 SyncTag, float ReplicatedValue);
+	void Server_SendReplicatedValue(int32 SyncTag, uint16 Timestamp, float ReplicatedValue);
 
 	UFUNCTION(NetMulticast, Reliable)
-	void Multicast_SendTerminalValue(int32 SyncTag, float TerminalValue);
+	void Multicast_SendTerminalValue(int32 SyncTag, uint16 Timestamp, float TerminalValue);
 
 	UFUNCTION(NetMulticast, Unreliable)
-	void Multicast_SendReplicatedValue(int32 SyncTag, float ReplicatedValue);
+	void Multicast_SendReplicatedValue(int32 SyncTag, uint16 Timestamp, float ReplicatedValue);
 
 	UFUNCTION(BlueprintCallable, Category = Network)
 	void SetValue(float InValue);
@@ -41,30 +42,14 @@ public:
 
 	bool ShouldTick() const;
 
+	virtual void WriteBatchedValue(FArchive& Ar) const override { WriteSmoothReplicatorValue(Ar, SmoothReplicator); }
+	virtual void ReadBatchedValue(FArchive& Ar, int32 SyncTag, uint16 Timestamp) override { ReadSmoothReplicatorValue(*this, SmoothReplicator, Ar, SyncTag, Timestamp); }
+
+protected:
+	virtual FFGReplicatorTickFunction GetTickFunction() const override { return &TickReplicatorGroup<UFGValueReplicator>; }
+
 private:
 	void BroadcastDelegate();
 
-	struct FCrumb
-	{
-		float Value;
-	};
-
-	TArray<FCrumb, TInlineAllocator<10>> CrumbTrail;
-
-	float ReplicatedValueTarget = 0.0f;
-	float ReplicatedValueCurrent = 0.0f;
-	float ReplicatedValuePreviouslySent = 0.0f;
-	float StaticValueTimer = 0.0f;
-	float SleepAfterDuration = 1.0f;
-	int32 NextSyncTag = 0;
-	int32 LastReceivedSyncTag = -1;
-	int32 LastReceivedCrumbSyncTag = -1;
-
-	float SyncTimer = 0.f;
-	float LerpSpeed = 1.f;
-	float CurrentCrumbTimeRemaining = 0.f;
-
-	bool bHasReceivedTerminalValue = false;
-	bool bHasSentTerminalValue = false;
-	bool bIsSleeping = false;
+	TFGSmoothReplicator<float> SmoothReplicator;
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "FGVectorReplicator.h"
+#include "Net/UnrealNetwork.h"
+
+static_assert(TIsSame<TFGSmoothReplicatorNetTraits<FVector>::FNetType, FVector_NetQuantize100>::Value, "RPC parameters have to match the net traits");
+
+void UFGVectorReplicator::Tick(float DeltaTime)
+{
+	TickSmoothReplicator(*this, SmoothReplicator, DeltaTime);
+}
+
+void UFGVectorReplicator::Init()
+{
+	SmoothReplicator.Init();
+}
+
+void UFGVectorReplicator::SetValue(const FVector& InValue)
+{
+	if (!IsLocallyControlled())
+		return;
+
+	if (!SmoothReplicator.SetValue(InValue))
+		return;
+
+	SetShouldTick(true);
+	BroadcastDelegate();
+}
+
+FVector UFGVectorReplicator::GetValue() const
+{
+	return SmoothReplicator.GetValue();
+}
+
+void UFGVectorReplicator::BroadcastDelegate()
+{
+	if (OnValueChanged.IsBound())
+		OnValueChanged.Broadcast();
+}
+
+void UFGVectorReplicator::Server_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, const FVector_NetQuantize100& TerminalValue)
+{
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
+		return;
+
+	Multicast_SendTerminalValue(SyncTag, Timestamp, TerminalValue);
+}
+
+void UFGVectorReplicator::Server_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, const FVector_NetQuantize100& ReplicatedValue)
+{
+	if (!SmoothReplicator.AcceptSyncTag(SyncTag))
+		return;
+
+	Multicast_SendReplicatedValue(SyncTag, Timestamp, ReplicatedValue);
+}
+
+void UFGVectorReplicator::Multicast_SendTerminalValue_Implementation(int32 SyncTag, uint16 Timestamp, const FVector_NetQuantize100& TerminalValue)
+{
+	if (IsLocallyControlled())
+		return;
+
+	// The server already dropped stale values when they arrived from the owner
+	if (SmoothReplicator.ReceiveTerminalValue(SyncTag, Timestamp, TFGSmoothReplicatorNetTraits<FVector>::FromNet(TerminalValue), !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
+}
+
+void UFGVectorReplicator::Multicast_SendReplicatedValue_Implementation(int32 SyncTag, uint16 Timestamp, const FVector_NetQuantize100& ReplicatedValue)
+{
+	if (IsLocallyControlled())
+		return;
+
+	if (SmoothReplicator.ReceiveReplicatedValue(SyncTag, Timestamp, TFGSmoothReplicatorNetTraits<FVector>::FromNet(ReplicatedValue), !HasAuthority(), NumberOfReplicationsPerSecond))
+		SetShouldTick(true);
+}
+
+bool UFGVectorReplicator::ShouldTick() const
+{
+	return SmoothReplicator.ShouldTick(IsLocallyControlled());
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "FGReplicatorBase.h"
+#include "FGSmoothReplicator.h"
+#include "FGVectorReplicator.generated.h"
+
+// Positions and velocities in one set of RPCs and crumbs instead of three float replicators
+UCLASS()
+class FGNET_API UFGVectorReplicator : public UFGReplicatorBase
+{
+	GENERATED_BODY()
+public:
+	void Tick(float DeltaTime);
+
+	virtual void Init() override;
+
+	UFUNCTION(Server, Reliable)
+	void Server_SendTerminalValue(int32 SyncTag, uint16 Timestamp, const FVector_NetQuantize100& TerminalValue);
+
+	UFUNCTION(Server, Unreliable)
+	void Server_SendReplicatedValue(int32 SyncTag, uint16 Timestamp, const FVector_NetQuantize100& ReplicatedValue);
+
+	UFUNCTION(NetMulticast, Reliable)
+	void Multicast_SendTerminalValue(int32 SyncTag, uint16 Timestamp, const FVector_NetQuantize100& TerminalValue);
+
+	UFUNCTION(NetMulticast, Unreliable)
+	void Multicast_SendReplicatedValue(int32 SyncTag, uint16 Timestamp, const FVector_NetQuantize100& ReplicatedValue);
+
+	UFUNCTION(BlueprintCallable, Category = Network)
+	void SetValue(const FVector& InValue);
+
+	UFUNCTION(BlueprintPure, Category = Network)
+	FVector GetValue() const;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta = (ClampMin = 1))
+	int32 NumberOfReplicationsPerSecond = 5;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	EFGSmoothReplicatorMode SmoothMode = EFGSmoothReplicatorMode::ConstantVelocity;
+
+	UPROPERTY(BlueprintAssignable)
+	FFGOnSmoothValueReplicationChanged OnValueChanged;
+
+	bool ShouldTick() const;
+
+	virtual void WriteBatchedValue(FArchive& Ar) const override { WriteSmoothReplicatorValue(Ar, SmoothReplicator); }
+	virtual void ReadBatchedValue(FArchive& Ar, int32 SyncTag, uint16 Timestamp) override { ReadSmoothReplicatorValue(*this, SmoothReplicator, Ar, SyncTag, Timestamp); }
+
+protected:
+	virtual FFGReplicatorTickFunction GetTickFunction() const override { return &TickReplicatorGroup<UFGVectorReplicator>; }
+
+private:
+	void BroadcastDelegate();
+
+	TFGSmoothReplicator<FVector> SmoothReplicator;
+};
@@ -2,4 +2,9 @@
 
 
 #include "FGNetGameModeBase.h"
+#include "Player/FGPlayerController.h"
 
+AFGNetGameModeBase::AFGNetGameModeBase()
+{
+	PlayerControllerClass = AFGPlayerController::StaticClass();
+}
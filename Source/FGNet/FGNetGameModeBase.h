@@ -14,4 +14,6 @@ class FGNET_API AFGNetGameModeBase : public AGameModeBase
 {
 	GENERATED_BODY()
 	
+public:
+	AFGNetGameModeBase();
 };
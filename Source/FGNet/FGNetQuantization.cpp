@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGNetQuantization.h"
+#include "Engine/NetSerialization.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/PackageMapClient.h"
+#include "Engine/World.h"
+#include "FGWorldSettings.h"
+
+FFGNetQuantization::FFGNetQuantization()
+	: FFGNetQuantization(FBox(FVector(-65536.0f), FVector(65536.0f)), 1.0f)
+{
+}
+
+FFGNetQuantization::FFGNetQuantization(const FBox& InBounds, float InPrecision)
+{
+	if (!ensure(InBounds.IsValid && InPrecision > 0.0f))
+	{
+		LocationBounds = FBox(FVector(-65536.0f), FVector(65536.0f));
+		LocationPrecision = 1.0f;
+	}
+	else
+	{
+		LocationBounds = InBounds;
+		LocationPrecision = InPrecision;
+	}
+
+	const FVector Size = LocationBounds.GetSize();
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const uint32 NumSteps = static_cast<uint32>(FMath::CeilToInt(Size[Axis] / LocationPrecision)) + 1;
+		LocationBits[Axis] = FMath::Clamp(static_cast<int32>(FMath::CeilLogTwo(NumSteps)), 1, 30);
+	}
+}
+
+const FFGNetQuantization& FFGNetQuantization::Get(UPackageMap* Map)
+{
+	UPackageMapClient* PackageMapClient = Cast<UPackageMapClient>(Map);
+	UNetConnection* Connection = PackageMapClient != nullptr ? PackageMapClient->GetConnection() : nullptr;
+	const UNetDriver* NetDriver = Connection != nullptr ? Connection->Driver : nullptr;
+	return Get(NetDriver != nullptr ? NetDriver->GetWorld() : nullptr);
+}
+
+const FFGNetQuantization& FFGNetQuantization::Get(const UWorld* World)
+{
+	if (World != nullptr)
+	{
+		if (const AFGWorldSettings* WorldSettings = Cast<AFGWorldSettings>(World->GetWorldSettings(false, false)))
+			return WorldSettings->GetNetQuantization();
+	}
+
+	return GetDefault();
+}
+
+const FFGNetQuantization& FFGNetQuantization::GetDefault()
+{
+	static const FFGNetQuantization Default;
+	return Default;
+}
+
+bool FFGNetQuantization::QuantizeLocation(const FVector& Location, FIntVector& OutQuantized) const
+{
+	if (!LocationBounds.IsInsideOrOn(Location))
+		return false;
+
+	const FVector Relative = (Location - LocationBounds.Min) / LocationPrecision;
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		const int32 MaxValue = (1 << LocationBits[Axis]) - 1;
+		OutQuantized[Axis] = FMath::Clamp(FMath::RoundToInt(Relative[Axis]), 0, MaxValue);
+	}
+
+	return true;
+}
+
+FVector FFGNetQuantization::DequantizeLocation(const FIntVector& Quantized) const
+{
+	return LocationBounds.Min + FVector(Quantized.X, Quantized.Y, Quantized.Z) * LocationPrecision;
+}
+
+void FFGNetQuantization::SerializeQuantizedLocation(FArchive& Ar, FIntVector& Quantized) const
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		uint32 Value = static_cast<uint32>(Quantized[Axis]);
+		Ar.SerializeBits(&Value, LocationBits[Axis]);
+		Quantized[Axis] = static_cast<int32>(Value);
+	}
+}
+
+void FFGNetQuantization::SerializeQuantizedLocationDelta(FArchive& Ar, FIntVector& Quantized, const FIntVector& Base)
+{
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		uint32 Delta = ZigZagEncode(Quantized[Axis] - Base[Axis]);
+		Ar.SerializeIntPacked(Delta);
+		Quantized[Axis] = Base[Axis] + ZigZagDecode(Delta);
+	}
+}
+
+void FFGNetQuantization::SerializeSignedUnitFloat(FArchive& Ar, float& Value, int32 NumBits)
+{
+	check(NumBits >= 2 && NumBits <= 16);
+
+	const int32 MaxMagnitude = (1 << (NumBits - 1)) - 1;
+	uint32 Packed = static_cast<uint32>(FMath::RoundToInt(FMath::Clamp(Value, -1.0f, 1.0f) * MaxMagnitude) + MaxMagnitude);
+	Ar.SerializeBits(&Packed, NumBits);
+
+	if (Ar.IsLoading())
+	{
+		Value = FMath::Clamp(static_cast<float>(static_cast<int32>(Packed) - MaxMagnitude) / MaxMagnitude, -1.0f, 1.0f);
+	}
+}
+
+void FFGNetQuantization::SerializeWrappedTime(FArchive& Ar, float& Time)
+{
+	uint32 TimeMs = GetWrappedTimeMs(Time);
+	Ar.SerializeBits(&TimeMs, 16);
+
+	if (Ar.IsLoading())
+	{
+		Time = static_cast<float>(TimeMs) / 1000.0f;
+	}
+}
+
+float FFGNetQuantization::GetWrappedTimeDelta(float To, float From)
+{
+	const int16 DeltaMs = static_cast<int16>(static_cast<uint16>(GetWrappedTimeMs(To) - GetWrappedTimeMs(From)));
+	return static_cast<float>(DeltaMs) / 1000.0f;
+}
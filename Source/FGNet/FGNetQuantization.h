@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPackageMap;
+class UWorld;
+
+// Shared bit-packing helpers for movement data. The location quantization is relative to a per-map bounds box
+// (see AFGWorldSettings), so server and clients must have loaded the same map before any movement is serialized.
+// Each world owns its own bounds, so several worlds in one process (PIE, listen server with a client) never share them.
+struct FGNET_API FFGNetQuantization
+{
+	FFGNetQuantization();
+	FFGNetQuantization(const FBox& InBounds, float InPrecision);
+
+	// Bounds of the world the connection behind Map belongs to, falls back to the default bounds if there is none
+	static const FFGNetQuantization& Get(UPackageMap* Map);
+	static const FFGNetQuantization& Get(const UWorld* World);
+	static const FFGNetQuantization& GetDefault();
+
+	const FBox& GetLocationBounds() const { return LocationBounds; }
+	float GetLocationPrecision() const { return LocationPrecision; }
+	int32 GetLocationBits(int32 Axis) const { return LocationBits[Axis]; }
+
+	// Returns false if the location is outside of the bounds and has to be sent unquantized
+	bool QuantizeLocation(const FVector& Location, FIntVector& OutQuantized) const;
+	FVector DequantizeLocation(const FIntVector& Quantized) const;
+
+	void SerializeQuantizedLocation(FArchive& Ar, FIntVector& Quantized) const;
+	static void SerializeQuantizedLocationDelta(FArchive& Ar, FIntVector& Quantized, const FIntVector& Base);
+
+	// Values in [-1, 1] packed into NumBits signed bits
+	static void SerializeSignedUnitFloat(FArchive& Ar, float& Value, int32 NumBits);
+
+	// Seconds packed as a 16 bit millisecond counter, which wraps every ~65 seconds
+	static void SerializeWrappedTime(FArchive& Ar, float& Time);
+	static uint32 GetWrappedTimeMs(float Time) { return static_cast<uint32>(FMath::RoundToInt(Time * 1000.0f)) & 0xFFFF; }
+
+	// Signed difference between two wrapped times, valid as long as they are less than ~32 seconds apart
+	static float GetWrappedTimeDelta(float To, float From);
+
+	static uint32 ZigZagEncode(int32 Value) { return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31); }
+	static int32 ZigZagDecode(uint32 Value) { return static_cast<int32>(Value >> 1) ^ -static_cast<int32>(Value & 1); }
+
+private:
+	FBox LocationBounds;
+	float LocationPrecision;
+	int32 LocationBits[3];
+};
@@ -7,87 +7,139 @@
 #include "Components/StaticMeshComponent.h"
 #include "DrawDebugHelpers.h"
 #include "Engine/World.h"
-#include "TimerManager.h"
 #include "Net/UnrealNetwork.h"
+#include "GameFramework/GameStateBase.h"
+#include "Pickup/FGPickupSubsystem.h"
+#include "FGTimerWheelSubsystem.h"
 
 // Sets default values
 AFGPickup::AFGPickup()
 {
-	PrimaryActorTick.bStartWithTickEnabled = true;
-	PrimaryActorTick.bCanEverTick = true;
+	// The bob and spin are drawn by the pickup subsystem, nothing on the actor changes per frame
+	PrimaryActorTick.bStartWithTickEnabled = false;
+	PrimaryActorTick.bCanEverTick = false;
 
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("SceneRoot"));
 
-	// this attaches to overlap event and we want it to be static in the world so it doesn't generate event each tick (coz if it changes location, it will generate event each time it moves)
+	// Only defines where the pickup can be collected, the pickup subsystem tests it against players without physics
 	SphereComponent = CreateDefaultSubobject<USphereComponent>(TEXT("Sphere"));
 	SphereComponent->SetupAttachment(RootComponent);
+	SphereComponent->SetGenerateOverlapEvents(false);
+	SphereComponent->SetCollisionProfileName(TEXT("NoCollision"));
 
-	// we move the meshcomponent instead. 
 	MeshComponent = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
 	MeshComponent->SetupAttachment(RootComponent);
 	MeshComponent->SetGenerateOverlapEvents(false);
 	MeshComponent->SetCollisionProfileName(TEXT("NoCollision"));
 
 	SetReplicates(true);
+	// Never flushed, respawn times of all pickups are replicated together by the pickup state replicator
+	NetDormancy = DORM_Initial;
 }
 
 void AFGPickup::BeginPlay()
 {
 	Super::BeginPlay();
 
-	SphereComponent->OnComponentBeginOverlap.AddDynamic(this, &AFGPickup::OverlapBegin);
-	CachedMeshRelativeLocation = MeshComponent->GetRelativeLocation();
+	UFGPickupSubsystem* PickupSubsystem = GetPickupSubsystem();
+	if (PickupSubsystem != nullptr && PickupSubsystem->RegisterPickup(this))
+	{
+		MeshComponent->SetVisibility(false);
+	}
+
+	// The replicated respawn time can arrive before the pickup begins play
+	if (bPickedUp)
+	{
+		SetPickupAvailable(false);
+	}
 }
 
 void AFGPickup::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	if (const UWorld* World = GetWorld())
+	if (UFGTimerWheelSubsystem* TimerWheelSubsystem = GetTimerWheelSubsystem())
 	{
-		World->GetTimerManager().ClearTimer(ReActivateHandle);
+		TimerWheelSubsystem->ClearTimer(ReActivateHandle);
 	}
+
+	if (UFGPickupSubsystem* PickupSubsystem = GetPickupSubsystem())
+	{
+		PickupSubsystem->UnregisterPickup(this);
+	}
+}
+
+UFGPickupSubsystem* AFGPickup::GetPickupSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr ? World->GetSubsystem<UFGPickupSubsystem>() : nullptr;
 }
 
-void AFGPickup::Tick(float DeltaTime)
+UFGTimerWheelSubsystem* AFGPickup::GetTimerWheelSubsystem() const
 {
-	Super::Tick(DeltaTime);
+	const UWorld* World = GetWorld();
+	return World != nullptr ? World->GetSubsystem<UFGTimerWheelSubsystem>() : nullptr;
+}
 
-	const float PulsatingValue = FMath::MakePulsatingValue(GetWorld()->GetTimeSeconds(), 0.65f) * 30.0f;
-	const FVector NewLocation = CachedMeshRelativeLocation + FVector(0.0f, 0.0f, PulsatingValue);
-	FHitResult Hit;
-	MeshComponent->SetRelativeLocation(NewLocation, false, &Hit, ETeleportType::TeleportPhysics);
-	MeshComponent->AddRelativeRotation(FRotator(0.0f, 20.0f * DeltaTime, 0.0f), false, &Hit, ETeleportType::TeleportPhysics);
+void AFGPickup::SetPickupAvailable(bool bAvailable)
+{
+	if (UFGPickupSubsystem* PickupSubsystem = GetPickupSubsystem())
+	{
+		PickupSubsystem->SetPickupAvailable(this, bAvailable);
+	}
 
+	if (PickupInstanceIndex == INDEX_NONE)
+	{
+		RootComponent->SetVisibility(bAvailable, true);
+	}
 }
 
 void AFGPickup::ReActivatePickup()
 {
 	bPickedUp = false;
-	RootComponent->SetVisibility(true, true);
-	SphereComponent->SetCollisionProfileName(TEXT("OverlapAllDynamic"));
-	SetActorTickEnabled(true);
+	SetPickupAvailable(true);
 }
 
-void AFGPickup::OverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 otherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AFGPickup::ObjectHasBeenPickedUp()
 {
-	if (bPickedUp)
-		return;
+	const float RespawnTime = GetServerWorldTime() + ReActivateTime;
 
-	if (AFGPlayer* Player = Cast<AFGPlayer>(OtherActor))
+	if (HasAuthority())
 	{
-		Player->OnPickup(this);
-		ObjectHasBeenPickedUp();
+		if (UFGPickupSubsystem* PickupSubsystem = GetPickupSubsystem())
+		{
+			PickupSubsystem->ReplicateRespawnTime(this, RespawnTime);
+		}
 	}
+
+	ApplyRespawnTime(RespawnTime);
 }
 
-void AFGPickup::ObjectHasBeenPickedUp()
+void AFGPickup::ApplyRespawnTime(float RespawnTime)
 {
+	UFGTimerWheelSubsystem* TimerWheelSubsystem = GetTimerWheelSubsystem();
+	TimerWheelSubsystem->ClearTimer(ReActivateHandle);
+
+	const float TimeUntilRespawn = RespawnTime - GetServerWorldTime();
+	if (TimeUntilRespawn <= 0.0f)
+	{
+		if (bPickedUp)
+		{
+			ReActivatePickup();
+		}
+		return;
+	}
+
 	bPickedUp = true;
-	SphereComponent->SetCollisionProfileName(TEXT("NoCollision"));
-	RootComponent->SetVisibility(false, true);
-	GetWorldTimerManager().SetTimer(ReActivateHandle, this, &AFGPickup::ReActivatePickup, ReActivateTime, false);
-	SetActorTickEnabled(false);
+	SetPickupAvailable(false);
+	ReActivateHandle = TimerWheelSubsystem->SetTimer(FSimpleDelegate::CreateUObject(this, &AFGPickup::ReActivatePickup), TimeUntilRespawn);
+}
+
+float AFGPickup::GetServerWorldTime() const
+{
+	const UWorld* World = GetWorld();
+	const AGameStateBase* GameState = World->GetGameState();
+	return GameState != nullptr && World->GetNetMode() == NM_Client ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
 }
 
 
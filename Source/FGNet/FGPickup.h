@@ -4,10 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "FGTimerWheel.h"
 #include "FGPickup.generated.h"
 
 class USphereComponent;
 class UStaticMeshComponent;
+class UFGPickupSubsystem;
+class UFGTimerWheelSubsystem;
 
 UENUM(BlueprintType)
 enum class EFGPickupTypes : uint8
@@ -29,11 +32,10 @@ protected:
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
-	virtual void Tick(float DeltaTime) override;
-
 	UPROPERTY(VisibleDefaultsOnly, Category = Collision)
 	USphereComponent* SphereComponent;
 
+	// Supplies mesh, materials and rest transform, the pickup subsystem draws it as an instance
 	UPROPERTY(VisibleDefaultsOnly, Category = Mesh)
 	UStaticMeshComponent* MeshComponent;
 
@@ -46,16 +48,27 @@ public:
 	UPROPERTY(EditAnywhere)
 	float ReActivateTime = 5.0f;
 
+	// Hides the pickup until it respawns, on the server this is also what gets replicated
 	void ObjectHasBeenPickedUp();
+
+	// RespawnTime is in server time, the pickup is unavailable until then
+	void ApplyRespawnTime(float RespawnTime);
 private:
-	FVector CachedMeshRelativeLocation = FVector::ZeroVector;
-	FTimerHandle ReActivateHandle;
+	friend class UFGPickupSubsystem;
 
-	UFUNCTION()
-	void ReActivatePickup();
+	UFGPickupSubsystem* GetPickupSubsystem() const;
+	void SetPickupAvailable(bool bAvailable);
+	float GetServerWorldTime() const;
+	UFGTimerWheelSubsystem* GetTimerWheelSubsystem() const;
+
+	FFGTimerWheelHandle ReActivateHandle;
 
 	UFUNCTION()
-	void OverlapBegin(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 otherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	void ReActivatePickup();
 
 	bool bPickedUp = false;
+
+	int32 CollectionIndex = INDEX_NONE;
+	int32 PickupGroupIndex = INDEX_NONE;
+	int32 PickupInstanceIndex = INDEX_NONE;
 };
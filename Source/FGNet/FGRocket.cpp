@@ -7,12 +7,14 @@
 #include "DrawDebugHelpers.h"
 #include "Components/StaticMeshComponent.h"
 #include "../FGNet/Player/FGPlayer.h"
+#include "Projectile/FGProjectileSubsystem.h"
+#include "Projectile/FGExplosionEffectSubsystem.h"
 
 // Sets default values
 AFGRocket::AFGRocket()
 {
 	PrimaryActorTick.bStartWithTickEnabled = false;
-	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bCanEverTick = false;
 
 	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("SceneCompRoot"));
 
@@ -21,100 +23,95 @@ AFGRocket::AFGRocket()
 	MeshComponent->SetGenerateOverlapEvents(false);
 	MeshComponent->SetCollisionProfileName(TEXT("NoCollision"));
 
-	SetReplicates(true);
+	// Every machine simulates rockets from the fire events in its own pool
+	SetReplicates(false);
 }
 
 void AFGRocket::BeginPlay()
 {
 	Super::BeginPlay();
 
-	CachedCollisionQueryParams.AddIgnoredActor(this);
-	//Owner will be the player that instantiated this.
-	CachedCollisionQueryParams.AddIgnoredActor(GetOwner());
-	
 	SetRocketVisibility(false);
 }
 
-// Called every frame
-void AFGRocket::Tick(float DeltaTime)
+void AFGRocket::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
-
-	LifeTimeElapsed -= DeltaTime;
-	DistanceMoved += MovementVelocity * DeltaTime;
+	Super::EndPlay(EndPlayReason);
 
-	FacingRotationStart = FQuat::Slerp(FacingRotationStart.ToOrientationQuat(), FacingRotationCorrection, 0.9f * DeltaTime).Vector();
-
-#if !UE_BUILD_SHIPPING
-	if (bDebugDrawCorrection)
+	if (UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem())
 	{
-		const float ArrowLength = 3000.0f;
-		const float ArrowSize = 50.0f;
-		DrawDebugDirectionalArrow(GetWorld(), RocketStartLocation, RocketStartLocation + OriginalFacingDirection * ArrowLength, ArrowSize, FColor::Red);
-		DrawDebugDirectionalArrow(GetWorld(), RocketStartLocation, RocketStartLocation + FacingRotationStart * ArrowLength, ArrowSize, FColor::Green);
+		ProjectileSubsystem->ForgetRocket(this);
 	}
-#endif  !UE_BUILD_SHIPPING
-
-	const FVector NewLocation = RocketStartLocation + FacingRotationStart * DistanceMoved;
-
-	SetActorLocation(NewLocation);
+}
 
-	FHitResult Hit;
-	const FVector StartLoc = NewLocation;
-	const FVector EndLoc = StartLoc + FacingRotationStart * 100.0f;
+void AFGRocket::AssignShot(AActor* Shooter, int32 InShotId)
+{
+	SetOwner(Shooter);
+	ShotId = InShotId;
 
-	GetWorld()->LineTraceSingleByChannel(Hit, StartLoc, EndLoc, ECC_Visibility, CachedCollisionQueryParams);
-	 
-	if (Hit.bBlockingHit)
-	{
-		Explode(Hit.Location);
-		ApplyDamage(Hit.GetActor());
-	}
+	const APawn* ShooterPawn = Cast<APawn>(Shooter);
+	SetInstigator(ShooterPawn != nullptr ? ShooterPawn->GetController() : nullptr);
 
-	if (LifeTimeElapsed < 0.0f)
-		Explode(Hit.Location);
+	CachedCollisionQueryParams.ClearIgnoredActors();
+	CachedCollisionQueryParams.AddIgnoredActor(this);
+	CachedCollisionQueryParams.AddIgnoredActor(Shooter);
 }
 
-void AFGRocket::StartMoving(const FVector& Forward, const FVector& InStartLocation)
+void AFGRocket::StartMoving(const FVector& Forward, const FVector& InStartLocation, float FireTime, float TargetRewindTime)
 {
-	FacingRotationStart = Forward;
-	FacingRotationCorrection = FacingRotationStart.ToOrientationQuat();
-	RocketStartLocation = InStartLocation;
 	SetActorLocationAndRotation(InStartLocation, Forward.Rotation());
 	bIsFree = false;
-	SetActorTickEnabled(true);
-	SetRocketVisibility(true);
-	LifeTimeElapsed = LifeTime;
-	DistanceMoved = 0.0f;
-	OriginalFacingDirection = FacingRotationStart;
+
+	if (UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem())
+	{
+		ProjectileSubsystem->AddProjectile(this, InStartLocation, Forward, FireTime, MovementVelocity, LifeTime, TargetRewindTime);
+	}
 }
 
-void AFGRocket::ApplyCorrection(const FVector& Forward)
+void AFGRocket::ApplyCorrection(const FVector& Forward, const FVector& InStartLocation, float FireTime)
 {
-	FacingRotationCorrection = Forward.ToOrientationQuat();
+	SetActorRotation(Forward.Rotation());
+
+	if (UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem())
+	{
+		ProjectileSubsystem->ApplyCorrection(this, InStartLocation, Forward, FireTime);
+	}
 }
 
 void AFGRocket::Explode(FVector HitLocation)
 {
-	if (Explosion != nullptr)
-		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Explosion, HitLocation, GetActorRotation(), true);
+	UFGExplosionEffectSubsystem* EffectSubsystem = GetWorld()->GetSubsystem<UFGExplosionEffectSubsystem>();
+	if (Explosion != nullptr && EffectSubsystem != nullptr)
+	{
+		EffectSubsystem->SpawnExplosion(Explosion, HitLocation, GetActorRotation());
+	}
 	MakeFree();
 }
 
 void AFGRocket::ApplyDamage(AActor* HitActor)
 {
-	AFGPlayer* Player = Cast<AFGPlayer>(HitActor);
-	if (Player && Player->IsLocallyControlled())
-	{
-		Player->Server_TakeDamage(ExplosionDamage);
-	}
+	// Clients simulate the same hits for visuals only, the server's hit is the one that counts
+	if (GetNetMode() == NM_Client)
+		return;
+
+	UGameplayStatics::ApplyDamage(HitActor, ExplosionDamage, ShootInstigator, this, DamageType);
 }
 
 void AFGRocket::MakeFree()
 {
 	bIsFree = true;
-	SetActorTickEnabled(false);
 	SetRocketVisibility(false);
+
+	if (UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem())
+	{
+		ProjectileSubsystem->ReleaseRocket(this);
+	}
+}
+
+UFGProjectileSubsystem* AFGRocket::GetProjectileSubsystem() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr ? World->GetSubsystem<UFGProjectileSubsystem>() : nullptr;
 }
 
 void AFGRocket::SetRocketVisibility(bool bVisible)
@@ -9,6 +9,7 @@
 class UStaticMeshComponent;
 class UParticleSystem;
 class UDamageType;
+class UFGProjectileSubsystem;
 
 UCLASS()
 class FGNET_API AFGRocket : public AActor
@@ -20,12 +21,19 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
-public:	
-	virtual void Tick(float DeltaTime) override;
+public:
+	// Pooled rockets are reused by any player, this binds the rocket to a new shot before it starts moving
+	void AssignShot(AActor* Shooter, int32 InShotId);
+	int32 GetShotId() const { return ShotId; }
+
+	// FireTime is in server time, the rocket's location at any moment follows from it and the start parameters.
+	// TargetRewindTime is only used on the server, see UFGProjectileSubsystem::bRewindTargets.
+	void StartMoving(const FVector& Forward, const FVector& InStartLocation, float FireTime, float TargetRewindTime = 0.0f);
+	void ApplyCorrection(const FVector& Forward, const FVector& InStartLocation, float FireTime);
 
-	void StartMoving(const FVector& Forward, const FVector& InStartLocation);
-	void ApplyCorrection(const FVector& Forward);
+	float GetLifeTime() const { return LifeTime; }
 
 	FORCEINLINE bool IsFree() const { return bIsFree; }
 
@@ -43,6 +51,11 @@ public:
 	void ApplyDamage(AActor* HitActor);
 
 private:
+	// Movement and collision are simulated for all rockets at once by the projectile subsystem
+	friend class UFGProjectileSubsystem;
+
+	UFGProjectileSubsystem* GetProjectileSubsystem() const;
+
 	void SetRocketVisibility(bool bVisible);
 
 	FCollisionQueryParams CachedCollisionQueryParams;
@@ -56,17 +69,11 @@ private:
 	UPROPERTY(EditAnywhere, Category = Debug)
 	bool bDebugDrawCorrection = true;
 
-	FVector OriginalFacingDirection = FVector::ZeroVector;
-
-	FVector FacingRotationStart = FVector::ZeroVector;
-	FQuat FacingRotationCorrection = FQuat::Identity;
-
-	FVector RocketStartLocation = FVector::ZeroVector;
+	int32 ProjectileIndex = INDEX_NONE;
+	int32 ShotId = INDEX_NONE;
+	bool bIsPooled = false;
 
 	float LifeTime = 2.0f;
-	float LifeTimeElapsed = 0.0f;
-
-	float DistanceMoved = 0.0f;
 
 	UPROPERTY(EditAnywhere)
 	float MovementVelocity = 1300.0f;
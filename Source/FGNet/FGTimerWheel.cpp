@@ -0,0 +1,220 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGTimerWheel.h"
+
+FFGTimerWheel::FFGTimerWheel(float InTickInterval)
+	: TickInterval(FMath::Max(InTickInterval, KINDA_SMALL_NUMBER))
+{
+	SlotHeads.Init(INDEX_NONE, ExpiredSlot + 1);
+	SlotTails.Init(INDEX_NONE, ExpiredSlot + 1);
+}
+
+FFGTimerWheelHandle FFGTimerWheel::SetTimer(FSimpleDelegate Delegate, float Delay)
+{
+	const int32 Index = AllocateTimer();
+	FTimer& Timer = Timers[Index];
+	Timer.Delegate = MoveTemp(Delegate);
+
+	// Part of the current tick has already passed, count from the tick boundary so the timer never fires early
+	const int64 NumTicks = FMath::CeilToInt((FMath::Max(Delay, 0.0f) + TimeAccumulator) / TickInterval);
+	Timer.ExpireTick = CurrentTick + FMath::Max<int64>(NumTicks, 1);
+	InsertIntoWheel(Index);
+
+	FFGTimerWheelHandle Handle;
+	Handle.Index = Index;
+	Handle.Generation = Timer.Generation;
+	return Handle;
+}
+
+void FFGTimerWheel::ClearTimer(FFGTimerWheelHandle& Handle)
+{
+	if (IsTimerActive(Handle))
+	{
+		UnlinkTimer(Handle.Index);
+		FreeTimer(Handle.Index);
+	}
+
+	Handle.Invalidate();
+}
+
+bool FFGTimerWheel::IsTimerActive(const FFGTimerWheelHandle& Handle) const
+{
+	return Timers.IsValidIndex(Handle.Index) && Timers[Handle.Index].Generation == Handle.Generation && Timers[Handle.Index].Slot != INDEX_NONE;
+}
+
+int32 FFGTimerWheel::Advance(float DeltaTime, int32 MaxFiresPerAdvance)
+{
+	TimeAccumulator += DeltaTime;
+	const int64 NumTicks = FMath::FloorToInt(TimeAccumulator / TickInterval);
+	TimeAccumulator -= NumTicks * TickInterval;
+
+	if (NumTimers == NumExpiredTimers)
+	{
+		// Nothing in the wheel, the slots do not have to be visited one by one
+		CurrentTick += NumTicks;
+	}
+	else
+	{
+		for (int64 Tick = 0; Tick < NumTicks; ++Tick)
+		{
+			TickWheel();
+		}
+	}
+
+	int32 NumFired = 0;
+	while (SlotHeads[ExpiredSlot] != INDEX_NONE && NumFired < MaxFiresPerAdvance)
+	{
+		const int32 Index = SlotHeads[ExpiredSlot];
+		FSimpleDelegate Delegate = MoveTemp(Timers[Index].Delegate);
+		UnlinkTimer(Index);
+		FreeTimer(Index);
+
+		// Freed first, so the delegate can set a new timer in the same slot
+		Delegate.ExecuteIfBound();
+		NumFired++;
+	}
+
+	return NumFired;
+}
+
+void FFGTimerWheel::Reset()
+{
+	Timers.Reset();
+	FreeIndices.Reset();
+	SlotHeads.Init(INDEX_NONE, ExpiredSlot + 1);
+	SlotTails.Init(INDEX_NONE, ExpiredSlot + 1);
+	CurrentTick = 0;
+	TimeAccumulator = 0.0f;
+	NumTimers = 0;
+	NumExpiredTimers = 0;
+}
+
+int32 FFGTimerWheel::AllocateTimer()
+{
+	NumTimers++;
+
+	if (FreeIndices.Num() > 0)
+		return FreeIndices.Pop(false);
+
+	return Timers.AddDefaulted();
+}
+
+void FFGTimerWheel::FreeTimer(int32 Index)
+{
+	FTimer& Timer = Timers[Index];
+	Timer.Delegate.Unbind();
+	Timer.Generation++;
+	FreeIndices.Add(Index);
+	NumTimers--;
+}
+
+void FFGTimerWheel::InsertIntoWheel(int32 Index)
+{
+	const uint64 ExpireTick = Timers[Index].ExpireTick;
+	if (ExpireTick <= CurrentTick)
+	{
+		LinkTimer(Index, ExpiredSlot);
+		return;
+	}
+
+	const uint64 Delta = ExpireTick - CurrentTick;
+	for (int32 Level = 0; Level < NumLevels; ++Level)
+	{
+		if (Delta < (1ull << (SlotBits * (Level + 1))))
+		{
+			LinkTimer(Index, Level * SlotsPerLevel + ((ExpireTick >> (SlotBits * Level)) & SlotMask));
+			return;
+		}
+	}
+
+	// Further out than the wheel reaches, park it in the last slot of the top level and let it cascade from there
+	const uint64 FarthestTick = CurrentTick + (1ull << (SlotBits * NumLevels)) - 1;
+	LinkTimer(Index, (NumLevels - 1) * SlotsPerLevel + ((FarthestTick >> (SlotBits * (NumLevels - 1))) & SlotMask));
+}
+
+void FFGTimerWheel::LinkTimer(int32 Index, int32 Slot)
+{
+	FTimer& Timer = Timers[Index];
+	Timer.Slot = Slot;
+	Timer.Previous = SlotTails[Slot];
+	Timer.Next = INDEX_NONE;
+
+	if (SlotTails[Slot] != INDEX_NONE)
+	{
+		Timers[SlotTails[Slot]].Next = Index;
+	}
+	else
+	{
+		SlotHeads[Slot] = Index;
+	}
+	SlotTails[Slot] = Index;
+
+	if (Slot == ExpiredSlot)
+	{
+		NumExpiredTimers++;
+	}
+}
+
+void FFGTimerWheel::UnlinkTimer(int32 Index)
+{
+	FTimer& Timer = Timers[Index];
+	const int32 Slot = Timer.Slot;
+
+	if (Timer.Previous != INDEX_NONE)
+	{
+		Timers[Timer.Previous].Next = Timer.Next;
+	}
+	else
+	{
+		SlotHeads[Slot] = Timer.Next;
+	}
+
+	if (Timer.Next != INDEX_NONE)
+	{
+		Timers[Timer.Next].Previous = Timer.Previous;
+	}
+	else
+	{
+		SlotTails[Slot] = Timer.Previous;
+	}
+
+	if (Slot == ExpiredSlot)
+	{
+		NumExpiredTimers--;
+	}
+
+	Timer.Slot = INDEX_NONE;
+	Timer.Previous = INDEX_NONE;
+	Timer.Next = INDEX_NONE;
+}
+
+void FFGTimerWheel::CascadeSlot(int32 Slot)
+{
+	int32 Index = SlotHeads[Slot];
+	SlotHeads[Slot] = INDEX_NONE;
+	SlotTails[Slot] = INDEX_NONE;
+
+	while (Index != INDEX_NONE)
+	{
+		const int32 Next = Timers[Index].Next;
+		InsertIntoWheel(Index);
+		Index = Next;
+	}
+}
+
+void FFGTimerWheel::TickWheel()
+{
+	CurrentTick++;
+
+	// Every time a level wraps around, the next slot of the level above is spread out over the levels below it
+	for (int32 Level = 1; Level < NumLevels; ++Level)
+	{
+		if (((CurrentTick >> (SlotBits * (Level - 1))) & SlotMask) != 0)
+			break;
+
+		CascadeSlot(Level * SlotsPerLevel + ((CurrentTick >> (SlotBits * Level)) & SlotMask));
+	}
+
+	CascadeSlot(CurrentTick & SlotMask);
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FGNET_API FFGTimerWheelHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+	void Invalidate() { Index = INDEX_NONE; }
+};
+
+/**
+ * Hierarchical timer wheel. Time advances in fixed ticks, timers due within the next 64 ticks sit in the slots of the
+ * first level and later ones in coarser levels, which move down a level each time the level below wraps around.
+ * Setting, clearing and expiring a timer are all constant time, independent of how many timers exist.
+ *
+ * Expired timers are queued and fired in the order they expired, at most MaxFiresPerAdvance per call to Advance.
+ */
+class FGNET_API FFGTimerWheel
+{
+public:
+	explicit FFGTimerWheel(float InTickInterval = 0.05f);
+
+	FFGTimerWheelHandle SetTimer(FSimpleDelegate Delegate, float Delay);
+	void ClearTimer(FFGTimerWheelHandle& Handle);
+	bool IsTimerActive(const FFGTimerWheelHandle& Handle) const;
+
+	// Returns how many timers fired
+	int32 Advance(float DeltaTime, int32 MaxFiresPerAdvance = MAX_int32);
+
+	void Reset();
+
+	int32 GetNumTimers() const { return NumTimers; }
+	int32 GetNumExpiredTimers() const { return NumExpiredTimers; }
+	float GetTickInterval() const { return TickInterval; }
+
+private:
+	static constexpr int32 SlotBits = 6;
+	static constexpr int32 SlotsPerLevel = 1 << SlotBits;
+	static constexpr int32 SlotMask = SlotsPerLevel - 1;
+	static constexpr int32 NumLevels = 4;
+	// Expired timers waiting to fire are kept in one more list after the wheel slots
+	static constexpr int32 ExpiredSlot = NumLevels * SlotsPerLevel;
+
+	struct FTimer
+	{
+		FSimpleDelegate Delegate;
+		uint64 ExpireTick = 0;
+		int32 Slot = INDEX_NONE;
+		int32 Previous = INDEX_NONE;
+		int32 Next = INDEX_NONE;
+		uint32 Generation = 0;
+	};
+
+	int32 AllocateTimer();
+	void FreeTimer(int32 Index);
+	void InsertIntoWheel(int32 Index);
+	void LinkTimer(int32 Index, int32 Slot);
+	void UnlinkTimer(int32 Index);
+	void CascadeSlot(int32 Slot);
+	void TickWheel();
+
+	TArray<FTimer> Timers;
+	TArray<int32> FreeIndices;
+
+	// Head and tail of every slot's list
+	TArray<int32> SlotHeads;
+	TArray<int32> SlotTails;
+
+	uint64 CurrentTick = 0;
+	float TickInterval = 0.05f;
+	float TimeAccumulator = 0.0f;
+	int32 NumTimers = 0;
+	int32 NumExpiredTimers = 0;
+};
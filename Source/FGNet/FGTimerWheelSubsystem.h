@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "FGTimerWheel.h"
+#include "FGTimerWheelSubsystem.generated.h"
+
+/**
+ * Per world timer wheel for the many short lived, rarely cancelled timers of pickups and pooled objects, so they
+ * stay out of the world timer manager's heap and show up under one stat.
+ */
+UCLASS(config = Game)
+class FGNET_API UFGTimerWheelSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+#pragma region FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+#pragma endregion
+
+	FFGTimerWheelHandle SetTimer(FSimpleDelegate Delegate, float Delay) { return TimerWheel.SetTimer(MoveTemp(Delegate), Delay); }
+	void ClearTimer(FFGTimerWheelHandle& Handle) { TimerWheel.ClearTimer(Handle); }
+	bool IsTimerActive(const FFGTimerWheelHandle& Handle) const { return TimerWheel.IsTimerActive(Handle); }
+
+	int32 GetNumTimers() const { return TimerWheel.GetNumTimers(); }
+
+	// Timers fire up to this much later than asked for
+	UPROPERTY(Config)
+	float TickInterval = 0.05f;
+
+	// Timers beyond this many in a frame fire in the next one
+	UPROPERTY(Config)
+	int32 MaxTimersPerFrame = 256;
+
+private:
+	FFGTimerWheel TimerWheel;
+};
@@ -0,0 +1,11 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGWorldSettings.h"
+
+void AFGWorldSettings::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	NetQuantization = FFGNetQuantization(NetQuantizationBounds, NetLocationPrecision);
+}
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/WorldSettings.h"
+#include "FGNetQuantization.h"
+#include "FGWorldSettings.generated.h"
+
+/**
+ * Per-map network settings. Server and clients read them from the same map, so they can be used as a shared quantization reference.
+ */
+UCLASS()
+class FGNET_API AFGWorldSettings : public AWorldSettings
+{
+	GENERATED_BODY()
+
+public:
+	virtual void PostInitializeComponents() override;
+
+	// Resolved from the properties below, use FFGNetQuantization::Get to look it up from a world or package map
+	const FFGNetQuantization& GetNetQuantization() const { return NetQuantization; }
+
+	// Every replicated location is quantized relative to this box, anything outside of it is sent unquantized
+	UPROPERTY(EditAnywhere, Category = Network)
+	FBox NetQuantizationBounds = FBox(FVector(-65536.0f), FVector(65536.0f));
+
+	// Size in units of one quantization step
+	UPROPERTY(EditAnywhere, Category = Network, meta = (ClampMin = 0.01f))
+	float NetLocationPrecision = 1.0f;
+
+private:
+	FFGNetQuantization NetQuantization;
+};
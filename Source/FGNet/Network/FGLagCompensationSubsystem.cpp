@@ -0,0 +1,286 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGLagCompensationSubsystem.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "../FGNet.h"
+#include "../Player/FGPlayer.h"
+#include "../Projectile/FGProjectileHitTest.h"
+
+void FFGLagCompensationHistory::Init(int32 InMaxSlots, int32 InNumSamples)
+{
+	MaxSlots = InMaxSlots;
+	NumSamples = FMath::RoundUpToPowerOfTwo(FMath::Max(InNumSamples, 2));
+	SampleMask = NumSamples - 1;
+	NewestRow = -1;
+	NumValidRows = 0;
+	TotalSamples = 0;
+
+	SampleTimes.SetNumZeroed(NumSamples);
+	Samples.SetNumZeroed(NumSamples * MaxSlots);
+	SlotAddedAtSample.SetNumZeroed(MaxSlots);
+	UsedSlots.Init(false, MaxSlots);
+}
+
+int32 FFGLagCompensationHistory::AddSlot()
+{
+	const int32 Slot = UsedSlots.Find(false);
+	if (Slot == INDEX_NONE)
+		return INDEX_NONE;
+
+	UsedSlots[Slot] = true;
+	SlotAddedAtSample[Slot] = TotalSamples;
+	return Slot;
+}
+
+void FFGLagCompensationHistory::RemoveSlot(int32 Slot)
+{
+	if (UsedSlots.IsValidIndex(Slot))
+	{
+		UsedSlots[Slot] = false;
+	}
+}
+
+void FFGLagCompensationHistory::BeginSample(float Time)
+{
+	const int32 PreviousRow = NewestRow;
+	NewestRow = (NewestRow + 1) & SampleMask;
+	NumValidRows = FMath::Min(NumValidRows + 1, NumSamples);
+	TotalSamples++;
+
+	SampleTimes[NewestRow] = Time;
+
+	if (PreviousRow >= 0)
+	{
+		FMemory::Memcpy(&Samples[NewestRow * MaxSlots], &Samples[PreviousRow * MaxSlots], sizeof(FVector4) * MaxSlots);
+	}
+}
+
+void FFGLagCompensationHistory::RecordSlot(int32 Slot, const FVector& Location, float Radius)
+{
+	check(NewestRow >= 0 && Slot >= 0 && Slot < MaxSlots);
+	Samples[NewestRow * MaxSlots + Slot] = FVector4(Location, Radius);
+}
+
+bool FFGLagCompensationHistory::Rewind(int32 Slot, float Time, FVector& OutLocation, float& OutRadius) const
+{
+	if (Slot < 0 || Slot >= MaxSlots || !UsedSlots[Slot])
+		return false;
+
+	int32 Age;
+	float Alpha;
+	if (!FindSampleAge(Time, Age, Alpha))
+		return false;
+
+	// Rows recorded before the slot was taken belong to whoever had it before
+	const uint32 SampleNumber = TotalSamples - 1 - Age;
+	if (SampleNumber < SlotAddedAtSample[Slot])
+		return false;
+
+	const FVector4& Older = Samples[GetRowIndex(Age) * MaxSlots + Slot];
+	if (Age == 0 || Alpha <= 0.0f)
+	{
+		OutLocation = FVector(Older);
+		OutRadius = Older.W;
+		return true;
+	}
+
+	const FVector4& Newer = Samples[GetRowIndex(Age - 1) * MaxSlots + Slot];
+	const FVector4 Result = Older + (Newer - Older) * Alpha;
+	OutLocation = FVector(Result);
+	OutRadius = Result.W;
+	return true;
+}
+
+float FFGLagCompensationHistory::GetOldestTime() const
+{
+	return NumValidRows > 0 ? SampleTimes[GetRowIndex(NumValidRows - 1)] : 0.0f;
+}
+
+float FFGLagCompensationHistory::GetNewestTime() const
+{
+	return NumValidRows > 0 ? SampleTimes[NewestRow] : 0.0f;
+}
+
+bool FFGLagCompensationHistory::FindSampleAge(float Time, int32& OutAge, float& OutAlpha) const
+{
+	if (NumValidRows == 0)
+		return false;
+
+	const float NewestTime = SampleTimes[NewestRow];
+	if (Time >= NewestTime)
+	{
+		OutAge = 0;
+		OutAlpha = 0.0f;
+		return true;
+	}
+
+	if (Time < SampleTimes[GetRowIndex(NumValidRows - 1)])
+		return false;
+
+	// Times decrease with age, find the youngest row that is not newer than Time
+	int32 Low = 1;
+	int32 High = NumValidRows - 1;
+	while (Low < High)
+	{
+		const int32 Middle = (Low + High) / 2;
+		if (SampleTimes[GetRowIndex(Middle)] <= Time)
+		{
+			High = Middle;
+		}
+		else
+		{
+			Low = Middle + 1;
+		}
+	}
+
+	OutAge = Low;
+	const float OlderTime = SampleTimes[GetRowIndex(Low)];
+	const float NewerTime = SampleTimes[GetRowIndex(Low - 1)];
+	OutAlpha = NewerTime > OlderTime ? (Time - OlderTime) / (NewerTime - OlderTime) : 0.0f;
+	return true;
+}
+
+void UFGLagCompensationSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	History.Init(MaxPlayers, NumHistorySamples);
+	PlayersBySlot.SetNumZeroed(MaxPlayers);
+}
+
+void UFGLagCompensationSubsystem::Tick(float DeltaTime)
+{
+	const float SampleInterval = 1.0f / SamplesPerSecond;
+
+	TimeSinceLastSample += DeltaTime;
+	if (TimeSinceLastSample < SampleInterval)
+		return;
+
+	// Keep the remainder so the rate does not drift down to the frame rate, but never owe more than one sample after a hitch
+	TimeSinceLastSample = FMath::Min(TimeSinceLastSample - SampleInterval, SampleInterval);
+
+	History.BeginSample(GetWorld()->GetTimeSeconds());
+	for (int32 Slot = 0; Slot < PlayersBySlot.Num(); ++Slot)
+	{
+		if (const AFGPlayer* Player = PlayersBySlot[Slot])
+		{
+			History.RecordSlot(Slot, Player->GetActorLocation(), Player->GetCollisionRadius());
+		}
+	}
+}
+
+bool UFGLagCompensationSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->IsGameWorld() && World->GetNetMode() != NM_Client;
+}
+
+TStatId UFGLagCompensationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFGLagCompensationSubsystem, STATGROUP_Tickables);
+}
+
+int32 UFGLagCompensationSubsystem::RegisterPlayer(AFGPlayer* Player)
+{
+	const int32 Slot = History.AddSlot();
+	if (Slot == INDEX_NONE)
+	{
+		UE_LOG(LogFGNet, Warning, TEXT("Lag compensation history is full, %s will not be rewound"), *GetNameSafe(Player));
+		return INDEX_NONE;
+	}
+
+	PlayersBySlot[Slot] = Player;
+	return Slot;
+}
+
+void UFGLagCompensationSubsystem::UnregisterPlayer(AFGPlayer* Player)
+{
+	const int32 Slot = Player->GetLagCompensationSlot();
+	if (PlayersBySlot.IsValidIndex(Slot) && PlayersBySlot[Slot] == Player)
+	{
+		PlayersBySlot[Slot] = nullptr;
+		History.RemoveSlot(Slot);
+	}
+}
+
+bool UFGLagCompensationSubsystem::RewindPlayer(const AFGPlayer* Player, float ServerTime, FVector& OutLocation, float& OutRadius) const
+{
+	if (Player == nullptr)
+		return false;
+
+	if (GetWorld()->GetTimeSeconds() - ServerTime > MaxRewindTime)
+		return false;
+
+	return History.Rewind(Player->GetLagCompensationSlot(), ServerTime, OutLocation, OutRadius);
+}
+
+void UFGLagCompensationSubsystem::GatherRewoundSpheres(float ServerTime, FFGHitSpheres& OutSpheres) const
+{
+	OutSpheres.Reset();
+
+	for (AFGPlayer* Player : PlayersBySlot)
+	{
+		// Players that died since then can no longer be hit
+		if (Player == nullptr || !Player->IsCollisionEnabled())
+			continue;
+
+		FVector Location;
+		float Radius;
+		if (RewindPlayer(Player, ServerTime, Location, Radius))
+		{
+			OutSpheres.Add(Location, Radius, Player);
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+// FGNet.LagCompensation.Benchmark [NumPlayers] [NumQueries]
+static FAutoConsoleCommand LagCompensationBenchmarkCommand(
+	TEXT("FGNet.LagCompensation.Benchmark"),
+	TEXT("Measures rewind queries per second against a full history. Args: [NumPlayers=64] [NumQueries=1000000]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const int32 NumPlayers = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : UFGLagCompensationSubsystem::MaxPlayers;
+		const int32 NumQueries = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 1000000;
+		const float SampleInterval = 1.0f / UFGLagCompensationSubsystem::SamplesPerSecond;
+
+		FFGLagCompensationHistory BenchmarkHistory;
+		BenchmarkHistory.Init(NumPlayers, UFGLagCompensationSubsystem::NumHistorySamples);
+		for (int32 Index = 0; Index < NumPlayers; ++Index)
+		{
+			BenchmarkHistory.AddSlot();
+		}
+
+		FRandomStream Random(1337);
+		for (int32 Sample = 0; Sample < BenchmarkHistory.GetNumSamples(); ++Sample)
+		{
+			BenchmarkHistory.BeginSample(Sample * SampleInterval);
+			for (int32 Slot = 0; Slot < NumPlayers; ++Slot)
+			{
+				BenchmarkHistory.RecordSlot(Slot, Random.VRand() * 5000.0f, 50.0f);
+			}
+		}
+
+		const float OldestTime = BenchmarkHistory.GetOldestTime();
+		const float TimeRange = BenchmarkHistory.GetNewestTime() - OldestTime;
+
+		int32 NumHits = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			FVector Location;
+			float Radius;
+			const int32 Slot = Random.RandHelper(NumPlayers);
+			if (BenchmarkHistory.Rewind(Slot, OldestTime + Random.GetFraction() * TimeRange, Location, Radius))
+			{
+				NumHits += Location.SizeSquared() < FMath::Square(2500.0f) ? 1 : 0;
+			}
+		}
+		const double ElapsedTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogFGNet, Display, TEXT("Lag compensation: %d queries against %d players x %d samples in %.3f ms, %.1f M queries/s (%d inside)"),
+			NumQueries, NumPlayers, BenchmarkHistory.GetNumSamples(), ElapsedTime * 1000.0, NumQueries / FMath::Max(ElapsedTime, 1e-9) / 1000000.0, NumHits);
+	}));
+#endif // !UE_BUILD_SHIPPING
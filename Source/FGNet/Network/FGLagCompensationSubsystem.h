@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "FGLagCompensationSubsystem.generated.h"
+
+class AFGPlayer;
+struct FFGHitSpheres;
+
+/**
+ * Fixed size ring of (time, location, radius) samples for a fixed number of player slots.
+ * Samples are stored time-major so rewinding many players to the same time reads neighbouring memory.
+ */
+class FGNET_API FFGLagCompensationHistory
+{
+public:
+	// NumSamples is rounded up to a power of two
+	void Init(int32 InMaxSlots, int32 InNumSamples);
+
+	int32 AddSlot();
+	void RemoveSlot(int32 Slot);
+
+	// Starts a new sample row, slots that are not recorded for it keep the location of the previous row
+	void BeginSample(float Time);
+	void RecordSlot(int32 Slot, const FVector& Location, float Radius);
+
+	// Returns false if the time is older than the history or older than when the slot was added
+	bool Rewind(int32 Slot, float Time, FVector& OutLocation, float& OutRadius) const;
+
+	int32 GetMaxSlots() const { return MaxSlots; }
+	int32 GetNumSamples() const { return NumSamples; }
+	float GetOldestTime() const;
+	float GetNewestTime() const;
+
+private:
+	// Finds the row at or just before Time, counted backwards from the newest row
+	bool FindSampleAge(float Time, int32& OutAge, float& OutAlpha) const;
+	int32 GetRowIndex(int32 Age) const { return (NewestRow - Age) & SampleMask; }
+
+	TArray<float> SampleTimes;
+	TArray<FVector4> Samples;
+	TArray<uint32> SlotAddedAtSample;
+	TBitArray<> UsedSlots;
+
+	int32 MaxSlots = 0;
+	int32 NumSamples = 0;
+	int32 SampleMask = 0;
+	int32 NewestRow = -1;
+	int32 NumValidRows = 0;
+	uint32 TotalSamples = 0;
+};
+
+/**
+ * Server side history of every AFGPlayer collision sphere. The projectile simulation rewinds targets to the time the
+ * shooter saw them, so a rocket that hit on the shooter's screen also hits on the server.
+ */
+UCLASS()
+class FGNET_API UFGLagCompensationSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+#pragma region FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+#pragma endregion
+
+	int32 RegisterPlayer(AFGPlayer* Player);
+	void UnregisterPlayer(AFGPlayer* Player);
+
+	bool RewindPlayer(const AFGPlayer* Player, float ServerTime, FVector& OutLocation, float& OutRadius) const;
+
+	// Collision spheres of every player that can still be hit, as they were at ServerTime
+	void GatherRewoundSpheres(float ServerTime, FFGHitSpheres& OutSpheres) const;
+
+	static const int32 MaxPlayers = 64;
+	static const int32 SamplesPerSecond = 64;
+
+	// One second of rows, the oldest one is (NumHistorySamples - 1) / SamplesPerSecond old
+	static const int32 NumHistorySamples = 64;
+
+	// How far back we allow rewinding, anything older is rejected
+	static constexpr float MaxRewindTime = 1.0f;
+
+private:
+	FFGLagCompensationHistory History;
+
+	UPROPERTY(Transient)
+	TArray<AFGPlayer*> PlayersBySlot;
+
+	float TimeSinceLastSample = 0.0f;
+};
@@ -0,0 +1,188 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGMovementRelaySubsystem.h"
+#include "Engine/World.h"
+#include "../Player/FGPlayerController.h"
+#include "../FGNet.h"
+
+void UFGMovementRelaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Sources.SetNum(MaxPlayers);
+	Receivers.SetNum(MaxPlayers);
+	RelayStates.SetNum(MaxPlayers * MaxPlayers);
+	Candidates.Reserve(MaxPlayers);
+}
+
+void UFGMovementRelaySubsystem::Tick(float DeltaTime)
+{
+	const float SendThreshold = 1.0f / MaxRelayRate;
+	const float BudgetBytes = BudgetBytesPerSecond * DeltaTime;
+
+	for (int32 ReceiverSlot = 0; ReceiverSlot < MaxPlayers; ++ReceiverSlot)
+	{
+		FFGRelayReceiver& Receiver = Receivers[ReceiverSlot];
+		AFGPlayerController* Controller = Receiver.Controller;
+
+		// Only remote connections receive relayed movement, the server sees everything already
+		if (Controller == nullptr || Controller->GetNetConnection() == nullptr || Controller->IsLocalController())
+			continue;
+
+		// Unused credit carries over so the rate does not depend on the server's frame rate, but only up to one tick's
+		// worth so a quiet period does not turn into a burst
+		Receiver.ByteCredit = FMath::Min(Receiver.ByteCredit + BudgetBytes, BudgetBytes);
+
+		// Dead players and spectators have no pawn, they see the world from wherever their camera is
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		Controller->GetPlayerViewPoint(ViewLocation, ViewRotation);
+		const FVector ViewDirection = ViewRotation.Vector();
+		const APawn* ReceiverPawn = Controller->GetPawn();
+
+		Candidates.Reset();
+		for (int32 SourceSlot = 0; SourceSlot < MaxPlayers; ++SourceSlot)
+		{
+			const FFGRelaySource& Source = Sources[SourceSlot];
+			if (Source.Player == nullptr || Source.Player == ReceiverPawn)
+				continue;
+
+			FFGRelayState& State = GetState(ReceiverSlot, SourceSlot);
+			if (State.LastSentVersion == Source.Version)
+				continue;
+
+			const float Priority = GetPriority(ViewLocation, ViewDirection, Source.Player);
+			if (Priority <= 0.0f)
+				continue;
+
+			State.Accumulator += DeltaTime * Priority;
+			if (State.Accumulator >= SendThreshold)
+			{
+				Candidates.Add({ SourceSlot, State.Accumulator });
+			}
+		}
+
+		Candidates.Sort([](const FFGRelayCandidate& A, const FFGRelayCandidate& B) { return A.Accumulator > B.Accumulator; });
+
+		// The top candidate always goes out while there is any credit, even if it costs more than what is left
+		for (const FFGRelayCandidate& Candidate : Candidates)
+		{
+			if (Receiver.ByteCredit <= 0.0f)
+				break;
+
+			const FFGRelaySource& Source = Sources[Candidate.SourceSlot];
+			Controller->Client_ReceiveRelayedMovement(Source.Player, Source.LatestMovement);
+			Receiver.ByteCredit -= EstimatedBytesPerUpdate;
+
+			FFGRelayState& State = GetState(ReceiverSlot, Candidate.SourceSlot);
+			State.Accumulator = 0.0f;
+			State.LastSentVersion = Source.Version;
+		}
+	}
+}
+
+bool UFGMovementRelaySubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->IsGameWorld() && World->GetNetMode() != NM_Client && World->GetNetMode() != NM_Standalone;
+}
+
+TStatId UFGMovementRelaySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFGMovementRelaySubsystem, STATGROUP_Tickables);
+}
+
+int32 UFGMovementRelaySubsystem::RegisterPlayer(AFGPlayer* Player)
+{
+	for (int32 Slot = 0; Slot < MaxPlayers; ++Slot)
+	{
+		if (Sources[Slot].Player == nullptr)
+		{
+			Sources[Slot].Player = Player;
+			Sources[Slot].Version = 0;
+
+			// Whoever had the slot before may have left state behind with every receiver
+			for (int32 ReceiverSlot = 0; ReceiverSlot < MaxPlayers; ++ReceiverSlot)
+			{
+				GetState(ReceiverSlot, Slot) = FFGRelayState();
+			}
+			return Slot;
+		}
+	}
+
+	UE_LOG(LogFGNet, Warning, TEXT("Movement relay is full, %s falls back to multicast"), *GetNameSafe(Player));
+	return INDEX_NONE;
+}
+
+void UFGMovementRelaySubsystem::UnregisterPlayer(AFGPlayer* Player)
+{
+	const int32 Slot = Player->GetMovementRelaySlot();
+	if (Sources.IsValidIndex(Slot) && Sources[Slot].Player == Player)
+	{
+		Sources[Slot].Player = nullptr;
+	}
+}
+
+int32 UFGMovementRelaySubsystem::RegisterReceiver(AFGPlayerController* Controller)
+{
+	for (int32 Slot = 0; Slot < MaxPlayers; ++Slot)
+	{
+		if (Receivers[Slot].Controller == nullptr)
+		{
+			Receivers[Slot] = FFGRelayReceiver();
+			Receivers[Slot].Controller = Controller;
+
+			for (int32 SourceSlot = 0; SourceSlot < MaxPlayers; ++SourceSlot)
+			{
+				GetState(Slot, SourceSlot) = FFGRelayState();
+			}
+			return Slot;
+		}
+	}
+
+	UE_LOG(LogFGNet, Warning, TEXT("Movement relay is full, %s receives no relayed movement"), *GetNameSafe(Controller));
+	return INDEX_NONE;
+}
+
+void UFGMovementRelaySubsystem::UnregisterReceiver(AFGPlayerController* Controller)
+{
+	const int32 Slot = Controller->GetMovementRelaySlot();
+	if (Receivers.IsValidIndex(Slot) && Receivers[Slot].Controller == Controller)
+	{
+		Receivers[Slot].Controller = nullptr;
+	}
+}
+
+void UFGMovementRelaySubsystem::SubmitMovement(AFGPlayer* Player, const FGNetMovement& Movement)
+{
+	const int32 Slot = Player->GetMovementRelaySlot();
+	if (!ensure(Sources.IsValidIndex(Slot) && Sources[Slot].Player == Player))
+		return;
+
+	FFGRelaySource& Source = Sources[Slot];
+	Source.LatestMovement = Movement;
+
+	// Zero is reserved for "never sent"
+	if (++Source.Version == 0)
+	{
+		Source.Version = 1;
+	}
+}
+
+float UFGMovementRelaySubsystem::GetPriority(const FVector& ViewLocation, const FVector& ViewDirection, const AFGPlayer* Source) const
+{
+	const FVector ToSource = Source->GetActorLocation() - ViewLocation;
+	const float DistanceSquared = ToSource.SizeSquared();
+	if (DistanceSquared > FMath::Square(MaxRelayDistance))
+		return 0.0f;
+
+	const float Distance = FMath::Sqrt(DistanceSquared);
+	const float DistancePriority = PriorityHalfDistance / (PriorityHalfDistance + Distance);
+
+	// Full priority in front of the receiver, scaled down towards BehindViewPriorityScale behind it
+	const float ViewDot = Distance > KINDA_SMALL_NUMBER ? FVector::DotProduct(ViewDirection, ToSource / Distance) : 1.0f;
+	const float ViewPriority = FMath::Lerp(BehindViewPriorityScale, 1.0f, ViewDot * 0.5f + 0.5f);
+
+	return FMath::Max(DistancePriority * ViewPriority, MinPriority);
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "../Player/FGPlayer.h"
+#include "FGMovementRelaySubsystem.generated.h"
+
+class AFGPlayerController;
+
+/**
+ * Server side relay of player movement. Instead of multicasting every received update, each connection gets the
+ * updates it cares most about: every (receiver, source) pair accumulates priority from distance, view direction and
+ * time since the last update, and the highest priorities are sent while the connection has byte credit left.
+ * Receivers are player controllers rather than pawns, so connections without a pawn keep receiving movement.
+ */
+UCLASS(config = Game)
+class FGNET_API UFGMovementRelaySubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+#pragma region FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+#pragma endregion
+
+	int32 RegisterPlayer(AFGPlayer* Player);
+	void UnregisterPlayer(AFGPlayer* Player);
+
+	int32 RegisterReceiver(AFGPlayerController* Controller);
+	void UnregisterReceiver(AFGPlayerController* Controller);
+
+	void SubmitMovement(AFGPlayer* Player, const FGNetMovement& Movement);
+
+	static const int32 MaxPlayers = 64;
+
+	// Rate a source gets when it has full priority for a receiver
+	UPROPERTY(Config)
+	float MaxRelayRate = 30.0f;
+
+	// Priority never drops below this, so even far away players keep updating at a few Hz
+	UPROPERTY(Config)
+	float MinPriority = 0.1f;
+
+	// Distance at which priority has dropped to half
+	UPROPERTY(Config)
+	float PriorityHalfDistance = 3000.0f;
+
+	// Priority multiplier for sources behind the receiver
+	UPROPERTY(Config)
+	float BehindViewPriorityScale = 0.5f;
+
+	// Sources further away than this are not relayed at all, matches the replication graph cull distance
+	UPROPERTY(Config)
+	float MaxRelayDistance = 15000.0f;
+
+	// Credit a connection earns per second, what is left over carries to the next tick up to one tick's worth
+	UPROPERTY(Config)
+	int32 BudgetBytesPerSecond = 6000;
+
+	// Rough size of one relayed update including RPC overhead
+	UPROPERTY(Config)
+	int32 EstimatedBytesPerUpdate = 16;
+
+private:
+	struct FFGRelaySource
+	{
+		AFGPlayer* Player = nullptr;
+		FGNetMovement LatestMovement;
+		uint32 Version = 0;
+	};
+
+	struct FFGRelayReceiver
+	{
+		AFGPlayerController* Controller = nullptr;
+		// Goes negative when the last update of a tick overshoots, the next ticks pay it back
+		float ByteCredit = 0.0f;
+	};
+
+	struct FFGRelayState
+	{
+		float Accumulator = 0.0f;
+		uint32 LastSentVersion = 0;
+	};
+
+	struct FFGRelayCandidate
+	{
+		int32 SourceSlot;
+		float Accumulator;
+	};
+
+	float GetPriority(const FVector& ViewLocation, const FVector& ViewDirection, const AFGPlayer* Source) const;
+	FFGRelayState& GetState(int32 ReceiverSlot, int32 SourceSlot) { return RelayStates[ReceiverSlot * MaxPlayers + SourceSlot]; }
+
+	TArray<FFGRelaySource> Sources;
+	TArray<FFGRelayReceiver> Receivers;
+	TArray<FFGRelayState> RelayStates;
+	TArray<FFGRelayCandidate> Candidates;
+};
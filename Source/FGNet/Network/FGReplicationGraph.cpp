@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGReplicationGraph.h"
+#include "ReplicationGraphTypes.h"
+#include "Engine/World.h"
+#include "../Player/FGPlayer.h"
+#include "../FGPickup.h"
+
+void UFGReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	FClassReplicationInfo PlayerInfo;
+	PlayerInfo.CullDistanceSquared = FMath::Square(CullDistance);
+	PlayerInfo.ReplicationPeriodFrame = 1;
+	GlobalActorReplicationInfoMap.SetClassInfo(AFGPlayer::StaticClass(), PlayerInfo);
+
+	// Pickups rarely change, they sit dormant in the grid until something flushes them
+	FClassReplicationInfo PickupInfo;
+	PickupInfo.CullDistanceSquared = FMath::Square(PickupCullDistance);
+	PickupInfo.ReplicationPeriodFrame = static_cast<uint8>(FMath::Clamp<uint32>(GetReplicationPeriodFrameForFrequency(2.0f), 1, MAX_uint8));
+	GlobalActorReplicationInfoMap.SetClassInfo(AFGPickup::StaticClass(), PickupInfo);
+}
+
+void UFGReplicationGraph::InitGlobalGraphNodes()
+{
+	Super::InitGlobalGraphNodes();
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = GridCellSize;
+	GridNode->SpatialBias = SpatialBias;
+	AddGlobalGraphNode(GridNode);
+
+	PickupGridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	PickupGridNode->CellSize = GridCellSize;
+	PickupGridNode->SpatialBias = SpatialBias;
+	AddGlobalGraphNode(PickupGridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+}
+
+void UFGReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	// The connection's own controller, pawn and view target
+	UReplicationGraphNode_AlwaysRelevant_ForConnection* AlwaysRelevantForConnectionNode = CreateNewNode<UReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AddConnectionGraphNode(AlwaysRelevantForConnectionNode, RepGraphConnection);
+}
+
+void UFGReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetRoute(ActorInfo.Class))
+	{
+	case EFGReplicationRoute::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+	case EFGReplicationRoute::Spatialized:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+	case EFGReplicationRoute::SpatializedDormancy:
+		PickupGridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+	default:
+		break;
+	}
+}
+
+void UFGReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetRoute(ActorInfo.Class))
+	{
+	case EFGReplicationRoute::AlwaysRelevant:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+	case EFGReplicationRoute::Spatialized:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+	case EFGReplicationRoute::SpatializedDormancy:
+		PickupGridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+	default:
+		break;
+	}
+}
+
+UFGReplicationGraph::EFGReplicationRoute UFGReplicationGraph::GetRoute(const UClass* ActorClass) const
+{
+	if (ActorClass->IsChildOf(AFGPickup::StaticClass()))
+		return EFGReplicationRoute::SpatializedDormancy;
+
+	if (ActorClass->IsChildOf(AFGPlayer::StaticClass()))
+		return EFGReplicationRoute::Spatialized;
+
+	const AActor* ActorCDO = ActorClass->GetDefaultObject<AActor>();
+
+	// Player controllers and anything else owner-only is picked up by the connection's own node
+	if (ActorCDO->bOnlyRelevantToOwner)
+		return EFGReplicationRoute::None;
+
+	// Game state, player states and other managers
+	if (ActorCDO->bAlwaysRelevant)
+		return EFGReplicationRoute::AlwaysRelevant;
+
+	return EFGReplicationRoute::Spatialized;
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "FGReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_AlwaysRelevant_ForConnection;
+
+/**
+ * Players are routed through a spatial grid, pickups through a grid that understands dormancy,
+ * and everything that has to reach every connection (game state, player states) through one shared list.
+ */
+UCLASS(Transient, config = Engine)
+class FGNET_API UFGReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	UPROPERTY(Config)
+	float GridCellSize = 10000.0f;
+
+	// Actors further than this from the viewer are not replicated, should be larger than what the camera can see
+	UPROPERTY(Config)
+	float CullDistance = 15000.0f;
+
+	UPROPERTY(Config)
+	float PickupCullDistance = 8000.0f;
+
+	// Grid bounds are grown when needed, this only avoids rebuilding the grid for actors close to the origin
+	UPROPERTY(Config)
+	FVector2D SpatialBias = FVector2D(-100000.0f, -100000.0f);
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode = nullptr;
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* PickupGridNode = nullptr;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode = nullptr;
+
+private:
+	enum class EFGReplicationRoute : uint8
+	{
+		None,
+		AlwaysRelevant,
+		Spatialized,
+		SpatializedDormancy,
+	};
+
+	EFGReplicationRoute GetRoute(const UClass* ActorClass) const;
+};
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGPickupStateReplicator.h"
+#include "Engine/World.h"
+#include "Net/UnrealNetwork.h"
+#include "FGPickupSubsystem.h"
+#include "../FGPickup.h"
+
+void FFGPickupState::PostReplicatedAdd(const FFGPickupStateArray& InArraySerializer)
+{
+	if (Pickup != nullptr)
+	{
+		Pickup->ApplyRespawnTime(RespawnTime);
+	}
+}
+
+void FFGPickupState::PostReplicatedChange(const FFGPickupStateArray& InArraySerializer)
+{
+	if (Pickup != nullptr)
+	{
+		Pickup->ApplyRespawnTime(RespawnTime);
+	}
+}
+
+AFGPickupStateReplicator::AFGPickupStateReplicator()
+{
+	PrimaryActorTick.bCanEverTick = false;
+
+	SetReplicates(true);
+	bAlwaysRelevant = true;
+	// Pickups are collected a few times a second at most, changes wait for the next update
+	NetUpdateFrequency = 10.0f;
+}
+
+void AFGPickupStateReplicator::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UFGPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UFGPickupSubsystem>())
+	{
+		PickupSubsystem->SetStateReplicator(this);
+	}
+}
+
+void AFGPickupStateReplicator::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	UFGPickupSubsystem* PickupSubsystem = GetWorld()->GetSubsystem<UFGPickupSubsystem>();
+	if (PickupSubsystem != nullptr && PickupSubsystem->GetStateReplicator() == this)
+	{
+		PickupSubsystem->SetStateReplicator(nullptr);
+	}
+}
+
+void AFGPickupStateReplicator::SetRespawnTime(AFGPickup* Pickup, float RespawnTime)
+{
+	FFGPickupState* PickupState = PickupStates.Items.FindByPredicate([Pickup](const FFGPickupState& State) { return State.Pickup == Pickup; });
+	if (PickupState == nullptr)
+	{
+		PickupState = &PickupStates.Items.AddDefaulted_GetRef();
+		PickupState->Pickup = Pickup;
+	}
+
+	PickupState->RespawnTime = RespawnTime;
+	PickupStates.MarkItemDirty(*PickupState);
+}
+
+void AFGPickupStateReplicator::RemovePickup(AFGPickup* Pickup)
+{
+	const int32 Index = PickupStates.Items.IndexOfByPredicate([Pickup](const FFGPickupState& State) { return State.Pickup == Pickup; });
+	if (Index != INDEX_NONE)
+	{
+		PickupStates.Items.RemoveAtSwap(Index);
+		PickupStates.MarkArrayDirty();
+	}
+}
+
+void AFGPickupStateReplicator::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AFGPickupStateReplicator, PickupStates);
+}
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "FGPickupStateReplicator.generated.h"
+
+class AFGPickup;
+class AFGPickupStateReplicator;
+
+// A pickup that has been collected at least once. It is available again once server time passes RespawnTime.
+USTRUCT()
+struct FFGPickupState : public FFastArraySerializerItem
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	AFGPickup* Pickup = nullptr;
+
+	// Server world time
+	UPROPERTY()
+	float RespawnTime = 0.0f;
+
+	void PostReplicatedAdd(const struct FFGPickupStateArray& InArraySerializer);
+	void PostReplicatedChange(const struct FFGPickupStateArray& InArraySerializer);
+};
+
+USTRUCT()
+struct FFGPickupStateArray : public FFastArraySerializer
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	TArray<FFGPickupState> Items;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FFGPickupState, FFGPickupStateArray>(Items, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FFGPickupStateArray> : public TStructOpsTypeTraitsBase2<FFGPickupStateArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
+/**
+ * Replicates when every pickup in the world respawns, so pickup actors themselves never have to leave dormancy.
+ * Only entries that changed since a connection last acknowledged them are sent, and clients respawn pickups on
+ * their own once the replicated time has passed. Spawned by the pickup subsystem on the server.
+ */
+UCLASS(NotBlueprintable, NotPlaceable)
+class FGNET_API AFGPickupStateReplicator : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AFGPickupStateReplicator();
+
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Server only
+	void SetRespawnTime(AFGPickup* Pickup, float RespawnTime);
+	void RemovePickup(AFGPickup* Pickup);
+
+	int32 GetNumPickupStates() const { return PickupStates.Items.Num(); }
+
+private:
+	UPROPERTY(Replicated)
+	FFGPickupStateArray PickupStates;
+};
@@ -0,0 +1,402 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGPickupSubsystem.h"
+#include "Engine/World.h"
+#include "Engine/StaticMesh.h"
+#include "GameFramework/WorldSettings.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Materials/MaterialInterface.h"
+#include "Components/SphereComponent.h"
+#include "EngineUtils.h"
+#include "../Player/FGPlayer.h"
+#include "FGPickupStateReplicator.h"
+#include "../FGPickup.h"
+
+DECLARE_STATS_GROUP(TEXT("FGPickups"), STATGROUP_FGPickups, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pickup Instances"), STAT_FGPickupInstances, STATGROUP_FGPickups);
+DECLARE_CYCLE_STAT(TEXT("Animate Pickup Instances"), STAT_FGAnimatePickupInstances, STATGROUP_FGPickups);
+DECLARE_CYCLE_STAT(TEXT("Collect Pickups"), STAT_FGCollectPickups, STATGROUP_FGPickups);
+
+// Custom data 0 holds the world time the instance was last shown, the spin starts from there
+static constexpr int32 ShownTimeCustomDataIndex = 0;
+
+void UFGPickupSubsystem::Deinitialize()
+{
+	for (FFGPickupInstanceGroup& Group : InstanceGroups)
+	{
+		if (IsValid(Group.InstancedMesh))
+		{
+			Group.InstancedMesh->DestroyComponent();
+		}
+	}
+
+	InstanceGroups.Reset();
+	CollectionPickups.Reset();
+	CollectionLocations.Reset();
+	CollectionRadii.Reset();
+	CollectionAvailable.Reset();
+	CollectionCells.Reset();
+
+	Super::Deinitialize();
+}
+
+void UFGPickupSubsystem::Tick(float DeltaTime)
+{
+	CollectPickups();
+
+	int32 NumInstances = 0;
+	for (const FFGPickupInstanceGroup& Group : InstanceGroups)
+	{
+		NumInstances += Group.Pickups.Num();
+	}
+	SET_DWORD_STAT(STAT_FGPickupInstances, NumInstances);
+
+	if (!bAnimateInMaterial)
+	{
+		TimeSinceAnimationUpdate += DeltaTime;
+		const bool bAnimate = AnimationUpdateRate <= 0.0f || TimeSinceAnimationUpdate >= 1.0f / AnimationUpdateRate;
+		if (bAnimate)
+		{
+			TimeSinceAnimationUpdate = 0.0f;
+		}
+
+		AnimateInstances(bAnimate);
+	}
+}
+
+bool UFGPickupSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->IsGameWorld() && CollectionPickups.Num() > 0;
+}
+
+TStatId UFGPickupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFGPickupSubsystem, STATGROUP_Tickables);
+}
+
+bool UFGPickupSubsystem::RegisterPickup(AFGPickup* Pickup)
+{
+	AddToCollection(Pickup);
+	return AddInstance(Pickup);
+}
+
+void UFGPickupSubsystem::UnregisterPickup(AFGPickup* Pickup)
+{
+	RemoveFromCollection(Pickup);
+	RemoveInstance(Pickup);
+
+	if (StateReplicator != nullptr && Pickup->HasAuthority())
+	{
+		StateReplicator->RemovePickup(Pickup);
+	}
+}
+
+void UFGPickupSubsystem::ReplicateRespawnTime(AFGPickup* Pickup, float RespawnTime)
+{
+	if (StateReplicator == nullptr)
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		StateReplicator = GetWorld()->SpawnActor<AFGPickupStateReplicator>(SpawnParameters);
+	}
+
+	if (StateReplicator != nullptr)
+	{
+		StateReplicator->SetRespawnTime(Pickup, RespawnTime);
+	}
+}
+
+void UFGPickupSubsystem::SetPickupAvailable(AFGPickup* Pickup, bool bAvailable)
+{
+	if (CollectionPickups.IsValidIndex(Pickup->CollectionIndex))
+	{
+		CollectionAvailable[Pickup->CollectionIndex] = bAvailable;
+	}
+
+	SetInstanceVisible(Pickup, bAvailable);
+}
+
+void UFGPickupSubsystem::AddToCollection(AFGPickup* Pickup)
+{
+	const USphereComponent* SphereComponent = Pickup->SphereComponent;
+	const FVector Location = SphereComponent->GetComponentLocation();
+	const float Radius = SphereComponent->GetScaledSphereRadius();
+
+	const int32 CollectionIndex = CollectionPickups.Add(Pickup);
+	CollectionLocations.Add(Location);
+	CollectionRadii.Add(Radius);
+	CollectionAvailable.Add(true);
+	CollectionCells.FindOrAdd(GetCollectionCell(Location)).Add(CollectionIndex);
+
+	// Pickups never move, so the largest radius only has to grow
+	MaxCollectionRadius = FMath::Max(MaxCollectionRadius, Radius);
+	Pickup->CollectionIndex = CollectionIndex;
+}
+
+void UFGPickupSubsystem::RemoveFromCollection(AFGPickup* Pickup)
+{
+	const int32 CollectionIndex = Pickup->CollectionIndex;
+	if (!CollectionPickups.IsValidIndex(CollectionIndex))
+		return;
+
+	const FIntVector Cell = GetCollectionCell(CollectionLocations[CollectionIndex]);
+	if (TArray<int32>* CellPickups = CollectionCells.Find(Cell))
+	{
+		CellPickups->RemoveSingleSwap(CollectionIndex, false);
+		if (CellPickups->Num() == 0)
+		{
+			CollectionCells.Remove(Cell);
+		}
+	}
+
+	// The last pickup moves into the freed slot, its cell has to point at the new index
+	const int32 LastIndex = CollectionPickups.Num() - 1;
+	if (CollectionIndex != LastIndex)
+	{
+		if (TArray<int32>* LastCellPickups = CollectionCells.Find(GetCollectionCell(CollectionLocations[LastIndex])))
+		{
+			LastCellPickups->Remove(LastIndex);
+			LastCellPickups->Add(CollectionIndex);
+		}
+
+		CollectionPickups[LastIndex]->CollectionIndex = CollectionIndex;
+		CollectionAvailable[CollectionIndex] = CollectionAvailable[LastIndex];
+	}
+
+	CollectionPickups.RemoveAtSwap(CollectionIndex, 1, false);
+	CollectionLocations.RemoveAtSwap(CollectionIndex, 1, false);
+	CollectionRadii.RemoveAtSwap(CollectionIndex, 1, false);
+	CollectionAvailable.RemoveAt(LastIndex);
+
+	Pickup->CollectionIndex = INDEX_NONE;
+}
+
+void UFGPickupSubsystem::CollectPickups()
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGCollectPickups);
+
+	// The server decides who gets a pickup, clients only predict it for their own pawn
+	const bool bIsServer = GetWorld()->GetNetMode() != NM_Client;
+
+	for (TActorIterator<AFGPlayer> Iterator(GetWorld()); Iterator; ++Iterator)
+	{
+		AFGPlayer* Player = *Iterator;
+		if (!Player->IsCollisionEnabled() || (!bIsServer && !Player->IsLocallyControlled()))
+			continue;
+
+		const FVector PlayerLocation = Player->GetActorLocation();
+		const float PlayerRadius = Player->GetCollisionRadius();
+		const FIntVector MinCell = GetCollectionCell(PlayerLocation - FVector(PlayerRadius + MaxCollectionRadius));
+		const FIntVector MaxCell = GetCollectionCell(PlayerLocation + FVector(PlayerRadius + MaxCollectionRadius));
+
+		CollectedPickups.Reset();
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+				{
+					const TArray<int32>* CellPickups = CollectionCells.Find(FIntVector(X, Y, Z));
+					if (CellPickups == nullptr)
+						continue;
+
+					for (const int32 Index : *CellPickups)
+					{
+						if (CollectionAvailable[Index] && FVector::DistSquared(PlayerLocation, CollectionLocations[Index]) <= FMath::Square(PlayerRadius + CollectionRadii[Index]))
+						{
+							CollectedPickups.Add(CollectionPickups[Index]);
+						}
+					}
+				}
+			}
+		}
+
+		// Collecting changes availability, so it happens after the cells have been walked
+		for (AFGPickup* Pickup : CollectedPickups)
+		{
+			if (!CollectionAvailable[Pickup->CollectionIndex])
+				continue;
+
+			if (bIsServer)
+			{
+				Player->OnPickup(Pickup);
+			}
+			Pickup->ObjectHasBeenPickedUp();
+		}
+	}
+}
+
+FIntVector UFGPickupSubsystem::GetCollectionCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CollectionCellSize),
+		FMath::FloorToInt(Location.Y / CollectionCellSize),
+		FMath::FloorToInt(Location.Z / CollectionCellSize));
+}
+
+void UFGPickupSubsystem::AnimateInstances(bool bAnimate)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGAnimatePickupInstances);
+
+	const float Time = GetWorld()->GetTimeSeconds();
+	for (FFGPickupInstanceGroup& Group : InstanceGroups)
+	{
+		const int32 NumGroupInstances = Group.Pickups.Num();
+		if (NumGroupInstances == 0)
+			continue;
+
+		// Groups nobody is looking at keep their last pose, but shown and hidden pickups still have to reach them
+		const bool bAnimateGroup = bAnimate && Group.InstancedMesh->WasRecentlyRendered();
+		if (!bAnimateGroup && !Group.bVisibilityChanged)
+			continue;
+
+		Group.bVisibilityChanged = false;
+
+		Group.AnimatedTransforms.SetNum(NumGroupInstances, false);
+		for (int32 Index = 0; Index < NumGroupInstances; ++Index)
+		{
+			if (Group.Visible[Index])
+			{
+				const float ShownTime = Group.InstancedMesh->PerInstanceSMCustomData[Index * Group.InstancedMesh->NumCustomDataFloats + ShownTimeCustomDataIndex];
+				Group.AnimatedTransforms[Index] = GetAnimatedTransform(Group.RestTransforms[Index], Time, ShownTime);
+			}
+			else
+			{
+				Group.AnimatedTransforms[Index] = FTransform(FQuat::Identity, Group.RestTransforms[Index].GetLocation(), FVector::ZeroVector);
+			}
+		}
+
+		// One render state update for the whole group instead of one per pickup
+		Group.InstancedMesh->BatchUpdateInstancesTransforms(0, Group.AnimatedTransforms, true, true, true);
+	}
+}
+
+bool UFGPickupSubsystem::AddInstance(AFGPickup* Pickup)
+{
+	UWorld* World = GetWorld();
+	UStaticMeshComponent* MeshComponent = Pickup->MeshComponent;
+	if (World == nullptr || World->GetNetMode() == NM_DedicatedServer || MeshComponent == nullptr || MeshComponent->GetStaticMesh() == nullptr)
+		return false;
+
+	UStaticMesh* Mesh = MeshComponent->GetStaticMesh();
+
+	// Pickups that override any slot, not just the first, need a group of their own
+	TArray<UMaterialInterface*, TInlineAllocator<4>> Materials;
+	for (int32 MaterialIndex = 0; MaterialIndex < MeshComponent->GetNumMaterials(); ++MaterialIndex)
+	{
+		Materials.Add(MeshComponent->GetMaterial(MaterialIndex));
+	}
+
+	int32 GroupIndex = InstanceGroups.IndexOfByPredicate([Mesh, &Materials](const FFGPickupInstanceGroup& Group)
+	{
+		return Group.Mesh == Mesh && Group.Materials.Num() == Materials.Num() && FMemory::Memcmp(Group.Materials.GetData(), Materials.GetData(), Materials.Num() * sizeof(UMaterialInterface*)) == 0;
+	});
+	if (GroupIndex == INDEX_NONE)
+	{
+		GroupIndex = InstanceGroups.AddDefaulted();
+		FFGPickupInstanceGroup& NewGroup = InstanceGroups[GroupIndex];
+		NewGroup.Mesh = Mesh;
+		NewGroup.Materials.Append(Materials.GetData(), Materials.Num());
+
+		UInstancedStaticMeshComponent* InstancedMesh = NewObject<UInstancedStaticMeshComponent>(World->GetWorldSettings());
+		InstancedMesh->SetMobility(EComponentMobility::Movable);
+		InstancedMesh->SetStaticMesh(Mesh);
+		for (int32 MaterialIndex = 0; MaterialIndex < Materials.Num(); ++MaterialIndex)
+		{
+			InstancedMesh->SetMaterial(MaterialIndex, Materials[MaterialIndex]);
+		}
+		InstancedMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		InstancedMesh->SetGenerateOverlapEvents(false);
+		InstancedMesh->NumCustomDataFloats = 1;
+		InstancedMesh->RegisterComponentWithWorld(World);
+		NewGroup.InstancedMesh = InstancedMesh;
+	}
+
+	FFGPickupInstanceGroup& Group = InstanceGroups[GroupIndex];
+	const FTransform RestTransform = MeshComponent->GetComponentTransform();
+	const int32 InstanceIndex = Group.InstancedMesh->AddInstanceWorldSpace(RestTransform);
+	Group.InstancedMesh->SetCustomDataValue(InstanceIndex, ShownTimeCustomDataIndex, World->GetTimeSeconds(), true);
+
+	Group.Pickups.Add(Pickup);
+	Group.RestTransforms.Add(RestTransform);
+	Group.Visible.Add(true);
+
+	Pickup->PickupGroupIndex = GroupIndex;
+	Pickup->PickupInstanceIndex = InstanceIndex;
+	return true;
+}
+
+void UFGPickupSubsystem::RemoveInstance(AFGPickup* Pickup)
+{
+	if (!InstanceGroups.IsValidIndex(Pickup->PickupGroupIndex))
+		return;
+
+	FFGPickupInstanceGroup& Group = InstanceGroups[Pickup->PickupGroupIndex];
+	const int32 InstanceIndex = Pickup->PickupInstanceIndex;
+	const int32 LastIndex = Group.Pickups.Num() - 1;
+
+	// Removing an instance shifts every instance after it, so the last one is moved into the hole instead
+	if (InstanceIndex != LastIndex && IsValid(Group.InstancedMesh))
+	{
+		FTransform LastTransform;
+		Group.InstancedMesh->GetInstanceTransform(LastIndex, LastTransform, true);
+		Group.InstancedMesh->UpdateInstanceTransform(InstanceIndex, LastTransform, true, false, true);
+
+		const float LastShownTime = Group.InstancedMesh->PerInstanceSMCustomData[LastIndex * Group.InstancedMesh->NumCustomDataFloats + ShownTimeCustomDataIndex];
+		Group.InstancedMesh->SetCustomDataValue(InstanceIndex, ShownTimeCustomDataIndex, LastShownTime, false);
+
+		Group.Pickups[LastIndex]->PickupInstanceIndex = InstanceIndex;
+	}
+
+	if (IsValid(Group.InstancedMesh))
+	{
+		Group.InstancedMesh->RemoveInstance(LastIndex);
+	}
+
+	Group.Pickups.RemoveAtSwap(InstanceIndex, 1, false);
+	Group.RestTransforms.RemoveAtSwap(InstanceIndex, 1, false);
+	Group.Visible.RemoveAtSwap(InstanceIndex, 1, false);
+
+	Pickup->PickupGroupIndex = INDEX_NONE;
+	Pickup->PickupInstanceIndex = INDEX_NONE;
+}
+
+void UFGPickupSubsystem::SetInstanceVisible(AFGPickup* Pickup, bool bVisible)
+{
+	if (!InstanceGroups.IsValidIndex(Pickup->PickupGroupIndex))
+		return;
+
+	FFGPickupInstanceGroup& Group = InstanceGroups[Pickup->PickupGroupIndex];
+	const int32 InstanceIndex = Pickup->PickupInstanceIndex;
+	if (Group.Visible[InstanceIndex] == bVisible)
+		return;
+
+	Group.Visible[InstanceIndex] = bVisible;
+	if (bVisible)
+	{
+		Group.InstancedMesh->SetCustomDataValue(InstanceIndex, ShownTimeCustomDataIndex, GetWorld()->GetTimeSeconds(), !bAnimateInMaterial);
+	}
+
+	Group.bVisibilityChanged = true;
+
+	// Without the per frame update nothing else would hide or show the instance
+	if (bAnimateInMaterial)
+	{
+		const FTransform& RestTransform = Group.RestTransforms[InstanceIndex];
+		const FTransform Transform = bVisible ? RestTransform : FTransform(FQuat::Identity, RestTransform.GetLocation(), FVector::ZeroVector);
+		Group.InstancedMesh->UpdateInstanceTransform(InstanceIndex, Transform, true, true, true);
+	}
+}
+
+FTransform UFGPickupSubsystem::GetAnimatedTransform(const FTransform& RestTransform, float Time, float ShownTime) const
+{
+	const float Bob = FMath::MakePulsatingValue(Time, BobFrequency) * BobHeight;
+	const FQuat Spin(FVector::UpVector, FMath::DegreesToRadians(SpinSpeed * (Time - ShownTime)));
+
+	FTransform Transform = RestTransform;
+	Transform.AddToTranslation(FVector(0.0f, 0.0f, Bob));
+	Transform.SetRotation(Spin * RestTransform.GetRotation());
+	return Transform;
+}
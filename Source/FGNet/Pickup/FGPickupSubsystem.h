@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "FGPickupSubsystem.generated.h"
+
+class AFGPickup;
+class UStaticMesh;
+class UMaterialInterface;
+class UInstancedStaticMeshComponent;
+class AFGPickupStateReplicator;
+
+// Every pickup drawn with the same mesh and materials, one instance each.
+USTRUCT()
+struct FFGPickupInstanceGroup
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	UStaticMesh* Mesh = nullptr;
+
+	// One per material slot of the mesh
+	UPROPERTY()
+	TArray<UMaterialInterface*> Materials;
+
+	UPROPERTY()
+	UInstancedStaticMeshComponent* InstancedMesh = nullptr;
+
+	// Indexed by instance
+	UPROPERTY()
+	TArray<AFGPickup*> Pickups;
+
+	TArray<FTransform> RestTransforms;
+	TArray<bool> Visible;
+
+	// An instance was shown or hidden since the transforms were last written
+	bool bVisibilityChanged = false;
+
+	// Scratch space for the per frame transform update
+	TArray<FTransform> AnimatedTransforms;
+};
+
+/**
+ * Collects and draws every pickup in the world.
+ *
+ * Pickup spheres live in a uniform spatial hash. Once per tick the server tests each player's sphere against the
+ * cells around it, so pickups need no physics bodies and becoming available again only flips a bit. Clients run the
+ * same test for their own pawn to hide a pickup right away, the respawn time replicated by the server is what counts.
+ *
+ * Draws all pickups through one instanced static mesh per mesh and material set, so pickup actors neither tick nor
+ * move components. The bob and spin are a function of world time shared by every pickup: the instance transforms of a
+ * group are rewritten in a single batch, or not at all when the material animates the instances itself using the world
+ * position offset and the spin phase in per-instance custom data 0. Every batch rebuilds the group's instance buffer,
+ * so it only happens at AnimationUpdateRate and only for groups that were on screen recently.
+ */
+UCLASS(config = Game)
+class FGNET_API UFGPickupSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+#pragma region FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+#pragma endregion
+
+	// Adds the pickup to collection and takes over drawing its mesh, returns false if the pickup has to draw itself
+	bool RegisterPickup(AFGPickup* Pickup);
+	void UnregisterPickup(AFGPickup* Pickup);
+
+	// Unavailable pickups are hidden and cannot be collected
+	void SetPickupAvailable(AFGPickup* Pickup, bool bAvailable);
+
+	int32 GetNumPickups() const { return CollectionPickups.Num(); }
+
+	// Server only, spawns the state replicator the first time a pickup is collected
+	void ReplicateRespawnTime(AFGPickup* Pickup, float RespawnTime);
+
+	AFGPickupStateReplicator* GetStateReplicator() const { return StateReplicator; }
+	void SetStateReplicator(AFGPickupStateReplicator* InStateReplicator) { StateReplicator = InStateReplicator; }
+
+	int32 GetNumInstanceGroups() const { return InstanceGroups.Num(); }
+
+	// Edge length of a spatial hash cell, about the size of a player plus a pickup works best
+	UPROPERTY(Config)
+	float CollectionCellSize = 400.0f;
+
+	// The material reads the bob and spin from time and custom data, the instance transforms never change.
+	// Needs a pickup material built for it, which the project does not have yet
+	UPROPERTY(Config)
+	bool bAnimateInMaterial = false;
+
+	// Instance transforms are rewritten at most this many times per second, 0 rewrites them every frame
+	UPROPERTY(Config)
+	float AnimationUpdateRate = 20.0f;
+
+	UPROPERTY(Config)
+	float BobHeight = 30.0f;
+
+	UPROPERTY(Config)
+	float BobFrequency = 0.65f;
+
+	// Degrees per second
+	UPROPERTY(Config)
+	float SpinSpeed = 20.0f;
+
+private:
+	void AddToCollection(AFGPickup* Pickup);
+	void RemoveFromCollection(AFGPickup* Pickup);
+	void CollectPickups();
+	FIntVector GetCollectionCell(const FVector& Location) const;
+
+	bool AddInstance(AFGPickup* Pickup);
+	void RemoveInstance(AFGPickup* Pickup);
+	void SetInstanceVisible(AFGPickup* Pickup, bool bVisible);
+	void AnimateInstances(bool bAnimate);
+
+	FTransform GetAnimatedTransform(const FTransform& RestTransform, float Time, float ShownTime) const;
+
+	UPROPERTY(Transient)
+	TArray<FFGPickupInstanceGroup> InstanceGroups;
+
+	// Indexed by collection index
+	UPROPERTY(Transient)
+	TArray<AFGPickup*> CollectionPickups;
+	TArray<FVector> CollectionLocations;
+	TArray<float> CollectionRadii;
+	TBitArray<> CollectionAvailable;
+
+	// Collection indices of the pickups whose center is in the cell
+	TMap<FIntVector, TArray<int32>> CollectionCells;
+	float MaxCollectionRadius = 0.0f;
+
+	TArray<AFGPickup*> CollectedPickups;
+
+	float TimeSinceAnimationUpdate = 0.0f;
+
+	UPROPERTY(Transient)
+	AFGPickupStateReplicator* StateReplicator = nullptr;
+};
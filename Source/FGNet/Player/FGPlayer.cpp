@@ -11,6 +11,7 @@
 #include "GameFramework/PlayerState.h"
 #include "../Components/FGMovementComponent.h"
 #include "../FGMovementStatics.h"
+#include "../FGNetQuantization.h"
 #include "Components/SceneComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "FGPlayerSettings.h"
@@ -20,10 +21,157 @@
 #include "../FGPickup.h"
 #include "Kismet/GameplayStatics.h"
 #include "Interfaces/IAnalyticsProvider.h"
+#include "../Network/FGLagCompensationSubsystem.h"
+#include "../Network/FGMovementRelaySubsystem.h"
+#include "../Projectile/FGProjectileSubsystem.h"
+#include "../Components/FGGameplayEventComponent.h"
 
 
 const static float MaxMoveDeltaTime = 0.125f;
 
+bool FGNetMovement::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	const FFGNetQuantization& Quantization = FFGNetQuantization::Get(Map);
+
+	FIntVector QuantizedLocation;
+	uint8 bQuantized = Ar.IsSaving() ? Quantization.QuantizeLocation(NetLocation, QuantizedLocation) : 0;
+	Ar.SerializeBits(&bQuantized, 1);
+
+	if (bQuantized)
+	{
+		Quantization.SerializeQuantizedLocation(Ar, QuantizedLocation);
+		if (Ar.IsLoading())
+		{
+			NetLocation = Quantization.DequantizeLocation(QuantizedLocation);
+		}
+	}
+	else
+	{
+		SerializePackedVector<1, 24>(NetLocation, Ar);
+	}
+
+	SerializeCompressedInput(Ar);
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void FFGFireEvent::Quantize(const FFGNetQuantization& Quantization)
+{
+	FIntVector QuantizedOrigin;
+	if (Quantization.QuantizeLocation(Origin, QuantizedOrigin))
+	{
+		Origin = Quantization.DequantizeLocation(QuantizedOrigin);
+	}
+	else
+	{
+		Origin = FVector(FMath::RoundToFloat(Origin.X), FMath::RoundToFloat(Origin.Y), FMath::RoundToFloat(Origin.Z));
+	}
+
+	Yaw = FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(Yaw));
+	ServerTime = FMath::RoundToFloat(ServerTime * 1000.0f) / 1000.0f;
+}
+
+bool FFGFireEvent::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	const FFGNetQuantization& Quantization = FFGNetQuantization::Get(Map);
+
+	Ar << ShotSequence;
+
+	FIntVector QuantizedOrigin;
+	uint8 bQuantized = Ar.IsSaving() ? Quantization.QuantizeLocation(Origin, QuantizedOrigin) : 0;
+	Ar.SerializeBits(&bQuantized, 1);
+
+	if (bQuantized)
+	{
+		Quantization.SerializeQuantizedLocation(Ar, QuantizedOrigin);
+		if (Ar.IsLoading())
+		{
+			Origin = Quantization.DequantizeLocation(QuantizedOrigin);
+		}
+	}
+	else
+	{
+		SerializePackedVector<1, 24>(Origin, Ar);
+	}
+
+	uint16 CompressedYaw = FRotator::CompressAxisToShort(Yaw);
+	Ar << CompressedYaw;
+	if (Ar.IsLoading())
+	{
+		Yaw = FRotator::DecompressAxisFromShort(CompressedYaw);
+	}
+
+	FFGNetQuantization::SerializeWrappedTime(Ar, ServerTime);
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void FGNetMovement::SerializeCompressedInput(FArchive& Ar)
+{
+	FFGNetQuantization::SerializeSignedUnitFloat(Ar, NetForward, NetForwardBits);
+	Ar << NetYaw;
+	FFGNetQuantization::SerializeWrappedTime(Ar, NetTime);
+}
+
+bool FFGNetMovementBatch::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	SerializeQuantized(Ar, FFGNetQuantization::Get(Map));
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+void FFGNetMovementBatch::SerializeQuantized(FArchive& Ar, const FFGNetQuantization& Quantization)
+{
+	uint32 NumMovements = FMath::Min(static_cast<uint32>(Movements.Num()), MaxMovements);
+	Ar.SerializeInt(NumMovements, MaxMovements + 1);
+
+	if (Ar.IsLoading())
+	{
+		Movements.SetNum(NumMovements);
+	}
+
+	FIntVector PreviousLocation;
+	bool bHasPrevious = false;
+	for (uint32 Index = 0; Index < NumMovements; ++Index)
+	{
+		FGNetMovement& Movement = Movements[Index];
+
+		FIntVector QuantizedLocation;
+		uint8 bQuantized = Ar.IsSaving() ? Quantization.QuantizeLocation(Movement.NetLocation, QuantizedLocation) : 0;
+		Ar.SerializeBits(&bQuantized, 1);
+
+		if (bQuantized)
+		{
+			if (bHasPrevious)
+			{
+				FFGNetQuantization::SerializeQuantizedLocationDelta(Ar, QuantizedLocation, PreviousLocation);
+			}
+			else
+			{
+				Quantization.SerializeQuantizedLocation(Ar, QuantizedLocation);
+			}
+
+			if (Ar.IsLoading())
+			{
+				Movement.NetLocation = Quantization.DequantizeLocation(QuantizedLocation);
+			}
+
+			PreviousLocation = QuantizedLocation;
+			bHasPrevious = true;
+		}
+		else
+		{
+			SerializePackedVector<1, 24>(Movement.NetLocation, Ar);
+			bHasPrevious = false;
+		}
+
+		Movement.SerializeCompressedInput(Ar);
+	}
+}
+
 AFGPlayer::AFGPlayer()
 {
 	PrimaryActorTick.bCanEverTick = true;
@@ -43,6 +191,7 @@ AFGPlayer::AFGPlayer()
 
 	MovementComponent = CreateDefaultSubobject<UFGMovementComponent>(TEXT("MovementComponent"));
 
+
 	SetReplicateMovement(false);
 }
 
@@ -50,8 +199,11 @@ void AFGPlayer::BeginPlay()
 {
 	Super::BeginPlay();
 
-	Health = DefaultHealth;
-	ServerHealth = Health;
+	// Clients get their health through replication, which may already have arrived by now
+	if (HasAuthority())
+	{
+		Health = DefaultHealth;
+	}
 
 	MovementComponent->SetUpdatedComponent(CollisionComponent);
 
@@ -61,10 +213,46 @@ void AFGPlayer::BeginPlay()
 		DebugMenuInstance->SetVisibility(ESlateVisibility::Collapsed);
 	}
 
-	SpawnRockets();
+	PrewarmRockets();
 
 	OriginalMeshOffset = MeshComponent->GetRelativeLocation();
 	OriginalMeshRotation = MeshComponent->GetRelativeRotation();
+
+	if (HasAuthority())
+	{
+		if (UFGLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UFGLagCompensationSubsystem>())
+		{
+			LagCompensationSlot = LagCompensation->RegisterPlayer(this);
+		}
+
+		if (UFGMovementRelaySubsystem* MovementRelay = GetWorld()->GetSubsystem<UFGMovementRelaySubsystem>())
+		{
+			MovementRelaySlot = MovementRelay->RegisterPlayer(this);
+		}
+	}
+}
+
+void AFGPlayer::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (LagCompensationSlot != INDEX_NONE)
+	{
+		if (UFGLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UFGLagCompensationSubsystem>())
+		{
+			LagCompensation->UnregisterPlayer(this);
+		}
+		LagCompensationSlot = INDEX_NONE;
+	}
+
+	if (MovementRelaySlot != INDEX_NONE)
+	{
+		if (UFGMovementRelaySubsystem* MovementRelay = GetWorld()->GetSubsystem<UFGMovementRelaySubsystem>())
+		{
+			MovementRelay->UnregisterPlayer(this);
+		}
+		MovementRelaySlot = INDEX_NONE;
+	}
 }
 
 void AFGPlayer::Tick(float DeltaTime)
@@ -78,7 +266,61 @@ void AFGPlayer::Tick(float DeltaTime)
 		return;
 	FFGFrameMovement FrameMovement = MovementComponent->CreateFrameMovement();
 
-	if (IsLocallyControlled())
+	if (IsLocallyControlled() && bUseServerAuthoritativeMovement)
+	{
+		ClientTimeStamp += DeltaTime;
+
+		FFGMoveCommand Command;
+		Command.Sequence = NextMoveSequence++;
+		Command.Forward = Forward;
+		Command.Turn = Turn;
+		Command.bBrake = bBrake;
+		Command.DeltaTime = FMath::Min(DeltaTime, MaxMoveDeltaTime);
+		Command.TimeStamp = ClientTimeStamp;
+
+		SimulateMove(Command);
+
+		if (!HasAuthority())
+		{
+			SaveMove(Command);
+			NumUnsentMoves++;
+		}
+
+		MovementSendTimer += DeltaTime;
+		const float SendInterval = 1.0f / MovementSendRate;
+		if (MovementSendTimer >= SendInterval)
+		{
+			MovementSendTimer = FMath::Min(MovementSendTimer - SendInterval, SendInterval);
+			SendMovementBatch();
+		}
+
+		// Ease the mesh back after a reconciliation moved the collision
+		if (bPerformNetWorkSmoothing)
+		{
+			const FVector NewRelativeLocation = FMath::VInterpTo(MeshComponent->GetRelativeLocation(), OriginalMeshOffset, DeltaTime, CorrectionSmoothingSpeed);
+			MeshComponent->SetRelativeLocation(NewRelativeLocation, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
+	else if (HasAuthority() && bUseServerAuthoritativeMovement)
+	{
+		MoveTimeBudget = FMath::Min(MoveTimeBudget + DeltaTime, MaxMoveTimeBudget);
+
+		// Remote pawns on the server are only simulated when their commands arrive, we just report the result once per frame
+		if (bPendingMoveAck)
+		{
+			FFGMoveCorrection Correction;
+			Correction.Sequence = LastProcessedMoveSequence;
+			Correction.Location = GetActorLocation();
+			Correction.Yaw = Yaw;
+			Correction.Velocity = MovementVelocity;
+			Correction.AccumulatedGravity = MovementComponent->GetAccumulatedGravity();
+			Client_AckMove(Correction);
+
+			RelayMovement(CreateNetMovement(LastProcessedMoveTimeStamp));
+			bPendingMoveAck = false;
+		}
+	}
+	else if (IsLocallyControlled())
 	{
 		ClientTimeStamp += DeltaTime;
 
@@ -92,7 +334,7 @@ void AFGPlayer::Tick(float DeltaTime)
 		FQuat WantedFacingDirection = FQuat(FVector::UpVector, FMath::DegreesToRadians(Yaw));
 		MovementComponent->SetFacingRotation(WantedFacingDirection, 10.5f);
 
-		AddMovementVelocity(DeltaTime);
+		AddMovementVelocity(DeltaTime, Forward);
 		MovementVelocity *= FMath::Pow(Friction, DeltaTime);
 
 		MovementComponent->ApplyGravity();
@@ -100,18 +342,32 @@ void AFGPlayer::Tick(float DeltaTime)
 		MovementComponent->Move(FrameMovement);
 
 		// Compress the data before sending to the Server
-		MovementToUpdate.NetLocation = GetActorLocation();
-		MovementToUpdate.NetForward = Forward;
-		MovementToUpdate.NetYaw = FMath::RoundToInt(GetActorRotation().Yaw * 256.0f / 360.0f) & 0xFF;// uint8
-		MovementToUpdate.NetTime = ClientTimeStamp;
+		MovementToUpdate = CreateNetMovement(ClientTimeStamp);
 
-		Server_SendMovement(MovementToUpdate);
+		MovementSendTimer += DeltaTime;
+		const float SendInterval = 1.0f / MovementSendRate;
+		if (MovementSendTimer >= SendInterval)
+		{
+			MovementSendTimer = FMath::Min(MovementSendTimer - SendInterval, SendInterval);
+			SendMovementBatch();
+		}
 
 		/* week 1 - movment assignment
 		Server_SendLocationAndRotation(StartLocation, StartRotation, DeltaTime);*/
 		/* week2 replicate data example
 		Server_SendYaw(MovementComponent->GetFacingRotation().Yaw);*/
 	}
+	else if (bUseSnapshotInterpolation)
+	{
+		FVector InterpolatedLocation;
+		float InterpolatedYaw;
+		if (SnapshotBuffer.Sample(DeltaTime, InterpolationDelay, MaxExtrapolationTime, InterpolatedLocation, InterpolatedYaw))
+		{
+			const FRotator InterpolatedRotation(0.0f, InterpolatedYaw, 0.0f);
+			MovementComponent->SetFacingRotation(InterpolatedRotation);
+			MovementComponent->UpdatedComponent->SetWorldLocationAndRotation(InterpolatedLocation, InterpolatedRotation, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+	}
 	else
 	{
 		const float Friction = IsBraking() ? PlayerSettings->BrakingFriction : PlayerSettings->Friction;
@@ -166,20 +422,105 @@ int32 AFGPlayer::GetPing() const
 	return 0;
 }
 
+float AFGPlayer::GetCollisionRadius() const
+{
+	return CollisionComponent->GetScaledSphereRadius();
+}
+
+bool AFGPlayer::IsCollisionEnabled() const
+{
+	return CollisionComponent->IsQueryCollisionEnabled();
+}
+
 #pragma region Week3 - Improve Movement
-void AFGPlayer::Server_SendMovement_Implementation(const FGNetMovement& MovementData)
+void AFGPlayer::Server_SendMovement_Implementation(const FFGNetMovementBatch& MovementBatch)
+{
+	// Oldest first, samples we have not relayed yet were either lost with an earlier batch or are new
+	for (const FGNetMovement& Movement : MovementBatch.Movements)
+	{
+		if (LastRelayedMovementTime >= 0.0f && FFGNetQuantization::GetWrappedTimeDelta(Movement.NetTime, LastRelayedMovementTime) <= 0.0f)
+			continue;
+
+		LastRelayedMovementTime = Movement.NetTime;
+		RelayMovement(Movement);
+	}
+}
+
+void AFGPlayer::SendMovementBatch()
 {
-	Multicast_SendMovement(MovementData);
+	if (bUseServerAuthoritativeMovement)
+	{
+		if (HasAuthority())
+		{
+			RelayMovement(CreateNetMovement(ClientTimeStamp));
+			return;
+		}
+
+		const int32 NumToSend = FMath::Min(NumSavedMoves, FMath::Min(NumUnsentMoves + NumRedundantMoves, MaxMovesPerBatch));
+		if (NumToSend == 0)
+			return;
+
+		TArray<FFGMoveCommand> Commands;
+		Commands.Reserve(NumToSend);
+		for (int32 Index = NumSavedMoves - NumToSend; Index < NumSavedMoves; ++Index)
+		{
+			Commands.Add(GetSavedMove(Index).Command);
+		}
+
+		Server_SendMoveCommands(Commands);
+		NumUnsentMoves = 0;
+	}
+	else
+	{
+		TArray<FGNetMovement>& History = SentMovementHistory.Movements;
+		History.Add(MovementToUpdate);
+		if (History.Num() > NumRedundantMoves + 1)
+		{
+			History.RemoveAt(0, History.Num() - (NumRedundantMoves + 1), false);
+		}
+
+		Server_SendMovement(SentMovementHistory);
+	}
 }
 
 void AFGPlayer::Multicast_SendMovement_Implementation(const FGNetMovement& MovementData)
 {
+	ReceiveMovement(MovementData);
+}
+
+void AFGPlayer::RelayMovement(const FGNetMovement& MovementData)
+{
+	UFGMovementRelaySubsystem* MovementRelay = GetWorld()->GetSubsystem<UFGMovementRelaySubsystem>();
+	if (!bUsePrioritizedMovementRelay || MovementRelay == nullptr || MovementRelaySlot == INDEX_NONE)
+	{
+		Multicast_SendMovement(MovementData);
+		return;
+	}
+
+	// The multicast used to run here as well, keep the server's copy of a client driven pawn up to date
+	ReceiveMovement(MovementData);
+	MovementRelay->SubmitMovement(this, MovementData);
+}
+
+void AFGPlayer::ReceiveMovement(const FGNetMovement& MovementData)
+{
+	// The server already holds the authoritative state
+	if (HasAuthority() && bUseServerAuthoritativeMovement)
+		return;
+
 	if (!IsLocallyControlled())
 	{
 		Forward = MovementData.NetForward;
-		const float DeltaTime = FMath::Min(MovementData.NetTime - ClientTimeStamp, MaxMoveDeltaTime);
+
+		if (bUseSnapshotInterpolation)
+		{
+			SnapshotBuffer.AddSnapshot(MovementData.NetTime, MovementData.NetLocation, (float)MovementData.NetYaw * 360.0f / 256.0f);
+			return;
+		}
+
+		const float DeltaTime = FMath::Clamp(FFGNetQuantization::GetWrappedTimeDelta(MovementData.NetTime, ClientTimeStamp), 0.0f, MaxMoveDeltaTime);
 		ClientTimeStamp = MovementData.NetTime;
-		AddMovementVelocity(DeltaTime);
+		AddMovementVelocity(DeltaTime, Forward);
 		////Decompress
 		FRotator DecompressdRotation = FRotator(0.0f, (float)MovementData.NetYaw * 360.0f / 256.0f, 0.0f);
 		MovementComponent->SetFacingRotation(DecompressdRotation);
@@ -201,7 +542,7 @@ void AFGPlayer::Multicast_SendMovement_Implementation(const FGNetMovement& Movem
 	}
 }
 
-void AFGPlayer::AddMovementVelocity(float DeltaTime)
+void AFGPlayer::AddMovementVelocity(float DeltaTime, float InForward)
 {
 	if (!ensure(PlayerSettings != nullptr))
 	{
@@ -210,9 +551,165 @@ void AFGPlayer::AddMovementVelocity(float DeltaTime)
 
 	const float MaxVelocity = PlayerSettings->MaxVelocity;
 	const float Acceleration = PlayerSettings->Acceleration;
-	MovementVelocity += Forward * Acceleration * DeltaTime;
+	MovementVelocity += InForward * Acceleration * DeltaTime;
 	MovementVelocity = FMath::Clamp(MovementVelocity, -MaxVelocity, MaxVelocity);
 }
+
+FGNetMovement AFGPlayer::CreateNetMovement(float TimeStamp) const
+{
+	FGNetMovement NetMovement;
+	NetMovement.NetLocation = GetActorLocation();
+	NetMovement.NetForward = Forward;
+	NetMovement.NetYaw = FMath::RoundToInt(GetActorRotation().Yaw * 256.0f / 360.0f) & 0xFF;// uint8
+	NetMovement.NetTime = TimeStamp;
+	return NetMovement;
+}
+#pragma endregion
+
+#pragma region Client Prediction / Server Reconciliation
+// One deterministic movement step. Runs on the owning client when predicting and replaying, and on the server when a command arrives.
+void AFGPlayer::SimulateMove(const FFGMoveCommand& Command)
+{
+	if (!ensure(PlayerSettings != nullptr))
+		return;
+
+	const float DeltaTime = Command.DeltaTime;
+	const float Friction = Command.bBrake ? PlayerSettings->BrakingFriction : PlayerSettings->Friction;
+	const float Alpha = FMath::Clamp(FMath::Abs(MovementVelocity / (PlayerSettings->MaxVelocity * 0.75f)), 0.0f, 1.0f);
+	const float TurnSpeed = FMath::InterpEaseOut(0.0f, PlayerSettings->TurnSpeedDefault, Alpha, 5.0f);
+	const float TurnDirection = (MovementVelocity > 0.0f) ? Command.Turn : -Command.Turn;
+
+	Yaw += (TurnDirection * TurnSpeed) * DeltaTime;
+	Yaw = FRotator::NormalizeAxis(Yaw);
+
+	// The facing is applied instantly, a smoothed rotation would make the step depend on how often the component ticks
+	const FRotator FacingRotation(0.0f, Yaw, 0.0f);
+	MovementComponent->SetFacingRotation(FacingRotation);
+
+	AddMovementVelocity(DeltaTime, Command.Forward);
+	MovementVelocity *= FMath::Pow(Friction, DeltaTime);
+
+	MovementComponent->ApplyGravity(DeltaTime);
+	FFGFrameMovement FrameMovement = MovementComponent->CreateFrameMovement();
+	FrameMovement.AddDelta(FacingRotation.Vector() * MovementVelocity * DeltaTime);
+	MovementComponent->Move(FrameMovement);
+}
+
+void AFGPlayer::Server_SendMoveCommands_Implementation(const TArray<FFGMoveCommand>& Commands)
+{
+	// Our own client never sends more, only the newest are kept from a larger batch
+	for (int32 Index = FMath::Max(Commands.Num() - MaxMovesPerBatch, 0); Index < Commands.Num(); ++Index)
+	{
+		ProcessMoveCommand(Commands[Index]);
+	}
+}
+
+void AFGPlayer::ProcessMoveCommand(const FFGMoveCommand& Command)
+{
+	if (bHasProcessedMove && !IsMoveSequenceNewer(Command.Sequence, LastProcessedMoveSequence))
+		return;
+
+	// Never trust the client with more than a clamped step
+	FFGMoveCommand ValidatedCommand = Command;
+	ValidatedCommand.Forward = FMath::Clamp(Command.Forward, -1.0f, 1.0f);
+	ValidatedCommand.Turn = FMath::Clamp(Command.Turn, -1.0f, 1.0f);
+	ValidatedCommand.DeltaTime = FMath::Clamp(Command.DeltaTime, 0.0f, MaxMoveDeltaTime);
+
+	// Commands beyond what the server's clock allows still get acknowledged, they just do not move anyone and the
+	// client is corrected back
+	ValidatedCommand.DeltaTime = FMath::Min(ValidatedCommand.DeltaTime, FMath::Max(MoveTimeBudget, 0.0f));
+	MoveTimeBudget -= ValidatedCommand.DeltaTime;
+
+	Forward = ValidatedCommand.Forward;
+	bBrake = ValidatedCommand.bBrake;
+	SimulateMove(ValidatedCommand);
+
+	LastProcessedMoveSequence = Command.Sequence;
+	LastProcessedMoveTimeStamp = Command.TimeStamp;
+	bHasProcessedMove = true;
+	bPendingMoveAck = true;
+}
+
+void AFGPlayer::Client_AckMove_Implementation(const FFGMoveCorrection& Correction)
+{
+	if (!IsMoveSequenceNewer(Correction.Sequence, LastAckedMoveSequence))
+		return;
+
+	LastAckedMoveSequence = Correction.Sequence;
+	ReconcileMoves(Correction);
+}
+
+void AFGPlayer::ReconcileMoves(const FFGMoveCorrection& Correction)
+{
+	// Find what we predicted for the acknowledged move before dropping it
+	FVector PredictedLocation = GetActorLocation();
+	bool bFoundMove = false;
+	for (int32 Index = 0; Index < NumSavedMoves; ++Index)
+	{
+		const FFGSavedMove& SavedMove = GetSavedMove(Index);
+		if (SavedMove.Command.Sequence == Correction.Sequence)
+		{
+			PredictedLocation = SavedMove.EndLocation;
+			bFoundMove = true;
+			break;
+		}
+	}
+
+	RemoveAcknowledgedMoves(Correction.Sequence);
+
+	if (bFoundMove && FVector::DistSquared(PredictedLocation, Correction.Location) <= FMath::Square(MoveCorrectionThreshold))
+		return;
+
+	// Rewind to the authoritative state and replay everything the server has not seen yet
+	const FVector MeshLocationBeforeCorrection = MeshComponent->GetComponentLocation();
+	{
+		const FScopedPreventAttachedComponentMove PreventMeshMove(MeshComponent);
+		MovementComponent->UpdatedComponent->SetWorldLocation(Correction.Location, false, nullptr, ETeleportType::TeleportPhysics);
+		Yaw = Correction.Yaw;
+		MovementVelocity = Correction.Velocity;
+		MovementComponent->SetAccumulatedGravity(Correction.AccumulatedGravity);
+		MovementComponent->SetFacingRotation(FRotator(0.0f, Yaw, 0.0f));
+
+		for (int32 Index = 0; Index < NumSavedMoves; ++Index)
+		{
+			FFGSavedMove& SavedMove = GetSavedMove(Index);
+			SimulateMove(SavedMove.Command);
+			SavedMove.EndLocation = GetActorLocation();
+		}
+	}
+
+	if (bPerformNetWorkSmoothing)
+	{
+		MeshComponent->SetWorldLocation(MeshLocationBeforeCorrection, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+	else
+	{
+		MeshComponent->SetRelativeLocation(OriginalMeshOffset, false, nullptr, ETeleportType::TeleportPhysics);
+	}
+}
+
+void AFGPlayer::SaveMove(const FFGMoveCommand& Command)
+{
+	// If the server falls this far behind we drop the oldest move, the next correction will snap us back anyway
+	if (NumSavedMoves == MaxSavedMoves)
+	{
+		SavedMoveHead = (SavedMoveHead + 1) & (MaxSavedMoves - 1);
+		NumSavedMoves--;
+	}
+
+	FFGSavedMove& SavedMove = GetSavedMove(NumSavedMoves++);
+	SavedMove.Command = Command;
+	SavedMove.EndLocation = GetActorLocation();
+}
+
+void AFGPlayer::RemoveAcknowledgedMoves(uint16 AckedSequence)
+{
+	while (NumSavedMoves > 0 && !IsMoveSequenceNewer(GetSavedMove(0).Command.Sequence, AckedSequence))
+	{
+		SavedMoveHead = (SavedMoveHead + 1) & (MaxSavedMoves - 1);
+		NumSavedMoves--;
+	}
+}
 #pragma endregion
 
 void AFGPlayer::Server_SendLocationAndRotation_Implementation(const FVector& LocationToSend, const FRotator& RotationToSend, float DeltaTime)
@@ -238,61 +735,59 @@ void AFGPlayer::Server_SendYaw_Implementation(float NewYaw)
 
 #pragma region Week2 - Pickup and Rocket
 
-void AFGPlayer::Server_TakeDamage_Implementation(float DamageAmout)
+float AFGPlayer::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	if (bIsDead)
-	{
-		return;
-	}
-	ServerHealth -= DamageAmout;
-	if (ServerHealth < Health)
-		Multicast_TakeDamage(DamageAmout);
-}
+	if (!HasAuthority() || bIsDead)
+		return 0.0f;
 
-void AFGPlayer::Multicast_TakeDamage_Implementation(float DamageAmout)
-{
-	if ((Health -= DamageAmout) <= 0.0f)
+	const float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+	if (ActualDamage <= 0.0f)
+		return 0.0f;
+
+	Health -= ActualDamage;
+	OnRep_Health();
+
+	if (Health <= 0.0f)
 	{
 		bIsDead = true;
-		CollisionComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		OnRep_IsDead();
 
 		DetachFromControllerPendingDestroy();
 		SetLifeSpan(1.0f);
 	}
 
+	return ActualDamage;
+}
+
+void AFGPlayer::OnRep_Health()
+{
 	OnHealthChanged(Health);
 }
 
-void AFGPlayer::OnPickup(AFGPickup* Pickup)
+void AFGPlayer::OnRep_IsDead()
 {
-	if (IsLocallyControlled())
+	if (bIsDead)
 	{
-		Server_OnPickup(Pickup);
+		CollisionComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	}
 }
 
-void AFGPlayer::Client_OnPickupRockets_Implementation(int32 PickedUpRockets, AFGPickup* Pickup)
-{
-	Pickup->ObjectHasBeenPickedUp();
-	NumRockets = PickedUpRockets;
-	BP_OnNumRocketsChanged(NumRockets);
-}
 
-void AFGPlayer::Server_OnPickup_Implementation(AFGPickup* Pickup)
+void AFGPlayer::OnPickup(AFGPickup* Pickup)
 {
+	// The pickup's own state and the new count both reach clients through replication
 	ServerNumRockets += Pickup->NumRockets;
-	Client_OnPickupRockets(ServerNumRockets, Pickup);
+	NumRockets = ServerNumRockets;
+	if (IsLocallyControlled())
+	{
+		BP_OnNumRocketsChanged(NumRockets);
+	}
 }
 
 int32 AFGPlayer::GetNumActiveRockets() const
 {
-	int32 NumActive = 0;
-	for (AFGRocket* Rocket : RocketInstances)
-	{
-		if (!Rocket->IsFree())
-			NumActive++;
-	}
-	return NumActive;
+	const UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem();
+	return ProjectileSubsystem != nullptr ? ProjectileSubsystem->GetNumActiveRockets(this) : 0;
 }
 
 void AFGPlayer::Handle_FirePressed()
@@ -311,65 +806,200 @@ void AFGPlayer::FireRocket()
 	if (GetNumActiveRockets() >= MaxActiveRockets)
 		return;
 
-	AFGRocket* NewRocket = GetFreeRocket();
-
-	if (!ensure(NewRocket != nullptr))
+	if (!ensure(GetProjectileSubsystem() != nullptr && RocketClass != nullptr))
 		return;
 
 	FireCooldownElapsed = PlayerSettings->FireCooldown;
 
 	if (GetLocalRole() >= ROLE_AutonomousProxy)
 	{
-		if (HasAuthority())
-		{
-			Server_FireRocket(NewRocket, GetRocketStartLocation(), GetActorRotation());
-		}
-		else // if we are local but not the host
+		FFGFireEvent FireEvent;
+		FireEvent.ShotSequence = NextShotSequence++;
+		FireEvent.Origin = GetRocketStartLocation();
+		FireEvent.Yaw = GetActorRotation().Yaw;
+		FireEvent.ServerTime = GetProjectileSubsystem()->GetServerWorldTime();
+		FireEvent.Quantize(FFGNetQuantization::Get(GetWorld()));
+
+		if (!HasAuthority()) // if we are local but not the host
 		{
 			NumRockets--;
-			NewRocket->StartMoving(GetActorForwardVector(), GetRocketStartLocation());
-			Server_FireRocket(NewRocket, GetRocketStartLocation(), GetActorRotation());
+			StartRocket(FireEvent);
 		}
+		Server_FireRocket(FireEvent);
 	}
 }
 
-void AFGPlayer::Server_FireRocket_Implementation(AFGRocket* NewRocket, const FVector& RocketStartLocation, const FRotator& RocketFacingRotation)
+void AFGPlayer::Server_FireRocket_Implementation(const FFGFireEvent& FireEvent)
 {
 	if ((ServerNumRockets - 1) < 0 && !bUnlimitedRockets)
 	{
-		Client_RemoveRocket(NewRocket);
+		FFGGameplayEvent Event;
+		Event.Type = EFGGameplayEventType::RocketRejected;
+		Event.Player = this;
+		Event.ShotSequence = FireEvent.ShotSequence;
+		UFGGameplayEventComponent::SendEventToOwner(this, Event);
 	}
 	else
 	{
+		FFGFireEvent ServerFireEvent = FireEvent;
+
 		//Rocket shooting direction based on player's facing direciton
-		const float DeltaYaw = FMath::FindDeltaAngleDegrees(RocketFacingRotation.Yaw, GetActorForwardVector().Rotation().Yaw) * 0.5f; // 0.5f is small offset
-		const FRotator NewFacingRotation = RocketFacingRotation + FRotator(0.0f, DeltaYaw, 0.0f);
+		const float DeltaYaw = FMath::FindDeltaAngleDegrees(FireEvent.Yaw, GetActorForwardVector().Rotation().Yaw) * 0.5f; // 0.5f is small offset
+		ServerFireEvent.Yaw = FRotator::NormalizeAxis(FireEvent.Yaw + DeltaYaw);
+
+		// Start the rocket where the shooter saw it start, within reason
+		const float ServerTime = GetWorld()->GetTimeSeconds();
+		const float FireDelay = FMath::Clamp(FFGNetQuantization::GetWrappedTimeDelta(ServerTime, FireEvent.ServerTime), 0.0f, MaxFireRewindTime);
+		ServerFireEvent.ServerTime = ServerTime - FireDelay;
+
+		// Other players were rendered an interpolation delay behind the server time the shooter fired at
+		ServerFireEvent.TargetRewindTime = FireDelay + InterpolationDelay;
+		ServerFireEvent.Quantize(FFGNetQuantization::Get(GetWorld()));
+
+		// The count reaches clients through replication, the shot itself only carries what is needed to rebuild the rocket
 		ServerNumRockets--;
-		Multicast_FireRocket(NewRocket, RocketStartLocation, NewFacingRotation, ServerNumRockets);
+		NumRockets = ServerNumRockets;
+		if (IsLocallyControlled())
+		{
+			BP_OnNumRocketsChanged(NumRockets);
+		}
+
+		ActiveShots.Add(ServerFireEvent);
+
+		FFGGameplayEvent Event;
+		Event.Type = EFGGameplayEventType::RocketFired;
+		Event.Player = this;
+		Event.FireEvent = ServerFireEvent;
+		UFGGameplayEventComponent::BroadcastEvent(GetWorld(), Event);
+	}
+}
+
+void AFGPlayer::OnRep_ActiveShots()
+{
+	const UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem();
+	const AFGRocket* RocketCDO = RocketClass != nullptr ? RocketClass->GetDefaultObject<AFGRocket>() : nullptr;
+	if (ProjectileSubsystem == nullptr || RocketCDO == nullptr)
+		return;
+
+	const float ServerTime = ProjectileSubsystem->GetServerWorldTime();
+	for (const FFGFireEvent& FireEvent : ActiveShots)
+	{
+		// Shots the server has not detonated yet can still be over by the time this arrives
+		if (FFGNetQuantization::GetWrappedTimeDelta(ServerTime, FireEvent.ServerTime) < RocketCDO->GetLifeTime())
+		{
+			ReceiveFireEvent(FireEvent);
+		}
 	}
 }
 
-void AFGPlayer::Multicast_FireRocket_Implementation(AFGRocket* NewRocket, const FVector& RocketStartLocation, const FRotator& RocketFacingRotation, int32 rocketLeft)
+void AFGPlayer::ReceiveFireEvent(const FFGFireEvent& FireEvent)
 {
-	if (!ensure(NewRocket != nullptr))
+	UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem();
+	if (!ensure(ProjectileSubsystem != nullptr))
 		return;
 
 	if (GetLocalRole() == ROLE_AutonomousProxy)
 	{
-		NewRocket->ApplyCorrection(RocketFacingRotation.Vector());
+		// The predicted rocket may already have exploded, then there is nothing left to correct
+		if (AFGRocket* PredictedRocket = ProjectileSubsystem->FindRocket(this, FireEvent.ShotSequence))
+		{
+			PredictedRocket->ApplyCorrection(FireEvent.GetDirection(), FireEvent.Origin, FireEvent.ServerTime);
+		}
 	}
-	else
+	else if (MarkShotSeen(FireEvent.ShotSequence))
 	{
-		NewRocket->StartMoving(RocketFacingRotation.Vector(), RocketStartLocation);
+		StartRocket(FireEvent);
 	}
-	NumRockets = rocketLeft;
-	BP_OnNumRocketsChanged(NumRockets);
-	
 }
 
-void AFGPlayer::Client_RemoveRocket_Implementation(AFGRocket* RocketToRemove)
+bool AFGPlayer::MarkShotSeen(uint16 ShotSequence)
 {
-	RocketToRemove->MakeFree();
+	// The first shot can have any sequence, late joiners see the shooter's counter wherever it happens to be
+	if (!bHasSeenShot)
+	{
+		bHasSeenShot = true;
+		LatestSeenShotSequence = ShotSequence;
+		SeenShotMask = 1;
+		return true;
+	}
+
+	const int16 Offset = static_cast<int16>(ShotSequence - LatestSeenShotSequence);
+	if (Offset > 0)
+	{
+		SeenShotMask = Offset < 32 ? (SeenShotMask << Offset) | 1 : 1;
+		LatestSeenShotSequence = ShotSequence;
+		return true;
+	}
+
+	// Too old to remember, the rocket would be long gone anyway
+	if (-Offset >= 32)
+		return false;
+
+	const uint32 Bit = 1u << -Offset;
+	if ((SeenShotMask & Bit) != 0)
+		return false;
+
+	SeenShotMask |= Bit;
+	return true;
+}
+
+void AFGPlayer::OnRocketDetonated(uint16 ShotSequence, const FVector& Location)
+{
+	ActiveShots.RemoveAll([ShotSequence](const FFGFireEvent& FireEvent) { return FireEvent.ShotSequence == ShotSequence; });
+
+	FFGGameplayEvent Event;
+	Event.Type = EFGGameplayEventType::RocketDetonated;
+	Event.Player = this;
+	Event.ShotSequence = ShotSequence;
+	Event.Location = Location;
+	UFGGameplayEventComponent::BroadcastEvent(GetWorld(), Event);
+}
+
+void AFGPlayer::HandleRocketDetonated(uint16 ShotSequence, const FVector& Location)
+{
+	if (HasAuthority())
+		return;
+
+	// Clients usually detonated the rocket themselves already, this only settles the cases where they disagree
+	UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem();
+	if (AFGRocket* Rocket = ProjectileSubsystem != nullptr ? ProjectileSubsystem->FindRocket(this, ShotSequence) : nullptr)
+	{
+		Rocket->Explode(Location);
+	}
+}
+
+void AFGPlayer::HandleRocketRejected(uint16 ShotSequence)
+{
+	UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem();
+	if (AFGRocket* RocketToRemove = ProjectileSubsystem != nullptr ? ProjectileSubsystem->FindRocket(this, ShotSequence) : nullptr)
+	{
+		RocketToRemove->MakeFree();
+	}
+}
+
+void AFGPlayer::HandleGameplayEvent(const FFGGameplayEvent& Event)
+{
+	switch (Event.Type)
+	{
+	case EFGGameplayEventType::RocketFired:
+		ReceiveFireEvent(Event.FireEvent);
+		break;
+	case EFGGameplayEventType::RocketDetonated:
+		HandleRocketDetonated(Event.ShotSequence, Event.Location);
+		break;
+	case EFGGameplayEventType::RocketRejected:
+		HandleRocketRejected(Event.ShotSequence);
+		break;
+	}
+}
+
+void AFGPlayer::StartRocket(const FFGFireEvent& FireEvent)
+{
+	UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem();
+	if (AFGRocket* NewRocket = ProjectileSubsystem != nullptr ? ProjectileSubsystem->AcquireRocket(RocketClass, this, FireEvent.ShotSequence) : nullptr)
+	{
+		NewRocket->StartMoving(FireEvent.GetDirection(), FireEvent.Origin, FireEvent.ServerTime, FireEvent.TargetRewindTime);
+	}
 }
 
 void AFGPlayer::Cheat_IncreaseRockets(int32 InNumRockets)
@@ -384,36 +1014,18 @@ FVector AFGPlayer::GetRocketStartLocation() const
 	return StartLoc;
 }
 
-AFGRocket* AFGPlayer::GetFreeRocket() const
+UFGProjectileSubsystem* AFGPlayer::GetProjectileSubsystem() const
 {
-	for (AFGRocket* Rocket : RocketInstances)
-	{
-		if (Rocket == nullptr)
-			continue;
-
-		if (Rocket->IsFree())
-			return Rocket;
-	}
-	return nullptr;
+	const UWorld* World = GetWorld();
+	return World != nullptr ? World->GetSubsystem<UFGProjectileSubsystem>() : nullptr;
 }
 
-void AFGPlayer::SpawnRockets()
+void AFGPlayer::PrewarmRockets()
 {
-	if (HasAuthority() && RocketClass != nullptr)
+	// The pool is shared by everyone in the world, each player only makes sure their own rockets will be ready
+	if (UFGProjectileSubsystem* ProjectileSubsystem = GetProjectileSubsystem())
 	{
-		const int32 RocketCache = 8;
-
-		for (int32 Index = 0; Index < RocketCache; ++Index)
-		{
-			FActorSpawnParameters SpawnParams;
-			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
-			SpawnParams.ObjectFlags = RF_Transient; // won't save in the level
-			SpawnParams.Instigator = this;
-			SpawnParams.Owner = this;
-			AFGRocket* NewRocketInstance = GetWorld()->SpawnActor<AFGRocket>(RocketClass, GetActorLocation(), GetActorRotation(), SpawnParams);
-			NewRocketInstance->SetInstigator(GetController());
-			RocketInstances.Add(NewRocketInstance);
-		}
+		ProjectileSubsystem->PrewarmPool(RocketClass, MaxActiveRockets);
 	}
 }
 #pragma endregion
@@ -499,8 +1111,8 @@ void AFGPlayer::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetim
 
 	DOREPLIFETIME(AFGPlayer, ReplicatedYaw);
 	DOREPLIFETIME(AFGPlayer, ReplicatedLocation);
-	DOREPLIFETIME(AFGPlayer, RocketInstances);
 	DOREPLIFETIME(AFGPlayer, NumRockets);
+	DOREPLIFETIME(AFGPlayer, ActiveShots);
 	DOREPLIFETIME(AFGPlayer, Health);
 	DOREPLIFETIME(AFGPlayer, bIsDead);
 
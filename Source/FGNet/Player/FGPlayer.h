@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Pawn.h"
+#include "FGSnapshotBuffer.h"
 #include "FGPlayer.generated.h"
 
 class UCameraComponent;
@@ -14,8 +15,11 @@ class USphereComponent;
 class UFGPlayerSettings;
 class UFGNetDebugWidget;
 class AFGRocket;
+class UFGProjectileSubsystem;
 class AFGPickup;
 class UMaterialInterface;
+struct FFGGameplayEvent;
+struct FFGNetQuantization;
 
 USTRUCT()
 struct FGNetMovement
@@ -26,16 +30,160 @@ public:
 	FGNetMovement() = default;
 
 	UPROPERTY()
-	FVector_NetQuantize NetLocation;
+	FVector NetLocation = FVector::ZeroVector;
 
 	UPROPERTY()
-	float NetForward;
+	float NetForward = 0.0f;
 
 	UPROPERTY()
-	uint8 NetYaw;
+	uint8 NetYaw = 0;
 
+	// Wraps every ~65 seconds once serialized, compare with FFGNetQuantization::GetWrappedTimeDelta
 	UPROPERTY()
-	float NetTime;
+	float NetTime = 0.0f;
+
+	static const int32 NetForwardBits = 4;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	// Writes everything but the location, which is either absolute or a delta depending on who serializes it
+	void SerializeCompressedInput(FArchive& Ar);
+};
+
+template<>
+struct TStructOpsTypeTraits<FGNetMovement> : public TStructOpsTypeTraitsBase2<FGNetMovement>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+// Movement samples sent together, every sample after the first is delta encoded against the one before it.
+// The base travels in the same packet, so the deltas never depend on an earlier packet having arrived.
+USTRUCT()
+struct FFGNetMovementBatch
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	TArray<FGNetMovement> Movements;
+
+	static const uint32 MaxMovements = 16;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	// NetSerialize with the bounds already resolved
+	void SerializeQuantized(FArchive& Ar, const FFGNetQuantization& Quantization);
+};
+
+template<>
+struct TStructOpsTypeTraits<FFGNetMovementBatch> : public TStructOpsTypeTraitsBase2<FFGNetMovementBatch>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+// Input for one simulation step, sent from the owning client to the server which runs the exact same step.
+USTRUCT()
+struct FFGMoveCommand
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	uint16 Sequence = 0;
+
+	UPROPERTY()
+	float Forward = 0.0f;
+
+	UPROPERTY()
+	float Turn = 0.0f;
+
+	UPROPERTY()
+	bool bBrake = false;
+
+	UPROPERTY()
+	float DeltaTime = 0.0f;
+
+	UPROPERTY()
+	float TimeStamp = 0.0f;
+};
+
+// Authoritative result of the last move the server processed, used by the owning client to reconcile.
+USTRUCT()
+struct FFGMoveCorrection
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	uint16 Sequence = 0;
+
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	UPROPERTY()
+	float Yaw = 0.0f;
+
+	UPROPERTY()
+	float Velocity = 0.0f;
+
+	// Fall speed the movement component has built up, replay starts from it like from the velocity
+	UPROPERTY()
+	float AccumulatedGravity = 0.0f;
+};
+
+// One rocket shot. Every machine builds the same rocket from it, so nothing else about the shot is replicated.
+// The origin is quantized against the map bounds rather than relative to the shooter, because each machine
+// only has its own interpolated view of the shooter and would rebuild a slightly different origin from it.
+USTRUCT()
+struct FFGFireEvent
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	UPROPERTY()
+	uint16 ShotSequence = 0;
+
+	UPROPERTY()
+	FVector Origin = FVector::ZeroVector;
+
+	UPROPERTY()
+	float Yaw = 0.0f;
+
+	// Wraps every ~65 seconds once serialized, compare with FFGNetQuantization::GetWrappedTimeDelta
+	UPROPERTY()
+	float ServerTime = 0.0f;
+
+	// Server only and never serialized, how far behind ServerTime the shooter saw the other players
+	float TargetRewindTime = 0.0f;
+
+	FVector GetDirection() const { return FRotator(0.0f, Yaw, 0.0f).Vector(); }
+
+	// Rounds origin and yaw the same way serialization does, so the sender simulates exactly what receivers will
+	void Quantize(const FFGNetQuantization& Quantization);
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FFGFireEvent> : public TStructOpsTypeTraitsBase2<FFGFireEvent>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+// A move the client has predicted but the server has not acknowledged yet.
+struct FFGSavedMove
+{
+	FFGMoveCommand Command;
+	FVector EndLocation = FVector::ZeroVector;
 };
 
 UCLASS()
@@ -48,6 +196,7 @@ public:
 
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 public:
 	virtual void Tick(float DeltaTime) override;
@@ -66,6 +215,11 @@ public:
 	UFUNCTION(BlueprintPure)
 	int32 GetPing() const;
 
+	float GetCollisionRadius() const;
+	bool IsCollisionEnabled() const;
+
+	int32 GetLagCompensationSlot() const { return LagCompensationSlot; }
+
 	// calling in very frame is better to do unreliable
 	UFUNCTION(Server, Unreliable)
 	void Server_SendLocationAndRotation(const FVector& LocationToSend, const FRotator& RotationToSend, float DeltaTime);
@@ -78,13 +232,74 @@ public:
 	float LerpRatio;
 	bool bNeedUpdate;
 
+	// Carries the newest sample and redundant copies of the previously sent ones, oldest first. The server relays
+	// every sample it has not relayed yet, so a lost batch is recovered by the next one.
 	UFUNCTION(Server, Unreliable)
-	void Server_SendMovement(const FGNetMovement& MovementData);
+	void Server_SendMovement(const FFGNetMovementBatch& MovementBatch);
 
 	UFUNCTION(NetMulticast, Unreliable)
 	void Multicast_SendMovement(const FGNetMovement& MovementData);
 #pragma endregion
 
+#pragma region Prioritized Movement Relay
+	// When enabled the server relays movement per connection by priority and bandwidth budget instead of multicasting every update
+	UPROPERTY(EditAnywhere, Category = Network)
+	bool bUsePrioritizedMovementRelay = true;
+
+	int32 GetMovementRelaySlot() const { return MovementRelaySlot; }
+
+	// Applies movement of this player received from the server
+	void ReceiveMovement(const FGNetMovement& MovementData);
+#pragma endregion
+
+#pragma region Client Prediction / Server Reconciliation
+	// When enabled the owning client sends input commands and the server simulates them, instead of the client sending its resulting location
+	UPROPERTY(EditAnywhere, Category = Network)
+	bool bUseServerAuthoritativeMovement = true;
+
+	// Errors below this distance (in units) are accepted without replaying the pending moves
+	UPROPERTY(EditAnywhere, Category = Network, meta = (ClampMin = 0.0f))
+	float MoveCorrectionThreshold = 2.0f;
+
+	UPROPERTY(EditAnywhere, Category = Network, meta = (ClampMin = 0.0f))
+	float CorrectionSmoothingSpeed = 10.0f;
+
+	// How many times per second the owning client sends its movement to the server, independent of frame rate
+	UPROPERTY(EditAnywhere, Category = Network, meta = (ClampMin = 1.0f))
+	float MovementSendRate = 30.0f;
+
+	// Number of already sent samples repeated in every batch to cover packet loss
+	UPROPERTY(EditAnywhere, Category = Network, meta = (ClampMin = 0, ClampMax = 8))
+	int32 NumRedundantMoves = 2;
+
+	// How far a client's commands may run ahead of the server's clock, covers commands that arrive bunched up
+	UPROPERTY(EditAnywhere, Category = Network, meta = (ClampMin = 0.0f))
+	float MaxMoveTimeBudget = 0.25f;
+
+	// Commands are sent oldest first, the server skips the ones it has already processed
+	UFUNCTION(Server, Unreliable)
+	void Server_SendMoveCommands(const TArray<FFGMoveCommand>& Commands);
+
+	UFUNCTION(Client, Unreliable)
+	void Client_AckMove(const FFGMoveCorrection& Correction);
+#pragma endregion
+
+#pragma region Snapshot Interpolation
+	// Simulated proxies render received movement a fixed delay in the past instead of extrapolating and snapping
+	UPROPERTY(EditAnywhere, Category = Network)
+	bool bUseSnapshotInterpolation = true;
+
+	// Should cover at least two send intervals so there is usually a newer snapshot to interpolate towards
+	UPROPERTY(EditAnywhere, Category = Network, meta = (ClampMin = 0.0f, EditCondition = "bUseSnapshotInterpolation"))
+	float InterpolationDelay = 0.1f;
+
+	UPROPERTY(EditAnywhere, Category = Network, meta = (ClampMin = 0.0f, EditCondition = "bUseSnapshotInterpolation"))
+	float MaxExtrapolationTime = 0.25f;
+
+	UFUNCTION(BlueprintPure, Category = Network)
+	FFGSnapshotBufferStats GetSnapshotBufferStats() const { return SnapshotBuffer.GetStats(); }
+#pragma endregion
+
 #pragma region Week2 - DebugMenu (for showing net conenctions options)
 	UPROPERTY(editAnywhere, Category = Debug)
 	TSubclassOf<UFGNetDebugWidget> DebugMenuClass;
@@ -102,32 +317,28 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Health")
 	float DefaultHealth = 100;
 
-	UPROPERTY(ReplicatedUsing=OnHealthChanged, VisibleAnywhere, BlueprintReadOnly, Category = "Health")
+	// Only the server changes health, clients get it through replication
+	UPROPERTY(ReplicatedUsing=OnRep_Health, VisibleAnywhere, BlueprintReadOnly, Category = "Health")
 	float Health;
 
-	UPROPERTY(Replicated, VisibleAnywhere, BlueprintReadOnly, Category = "Health")
+	UPROPERTY(ReplicatedUsing=OnRep_IsDead, VisibleAnywhere, BlueprintReadOnly, Category = "Health")
 	bool bIsDead = false;
 
-	UFUNCTION(Server, Reliable)
-	void Server_TakeDamage(float DamageAmout);
+	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
+
+	UFUNCTION()
+	void OnRep_Health();
 
-	UFUNCTION(NetMulticast, Reliable)
-	void Multicast_TakeDamage(float DamageAmout);
+	UFUNCTION()
+	void OnRep_IsDead();
 
 	UFUNCTION(BlueprintImplementableEvent, Category = "Events")
 	void OnHealthChanged(float CurrentHealth);
 
-	float ServerHealth = 0.0f;
-
 
+	// Server only, called by the pickup subsystem when the player touches an available pickup
 	void OnPickup(AFGPickup* Pickup);
 
-	UFUNCTION(Server, Reliable)
-	void Server_OnPickup(AFGPickup* Pickup);
-
-	UFUNCTION(NetMulticast, Reliable)
-	void Client_OnPickupRockets(int32 PickedUpRockets, AFGPickup* Pickup);
-
 	UFUNCTION(BlueprintPure)
 	int32 GetNumRockets() const { return NumRockets; }
 
@@ -138,11 +349,25 @@ public:
 
 	void FireRocket();
 
-	void SpawnRockets();
+	// Server only, called by the projectile subsystem when one of this player's rockets hits something or expires
+	void OnRocketDetonated(uint16 ShotSequence, const FVector& Location);
+
+	void PrewarmRockets();
+
+	// Called for every gameplay event about this player, on the server and on clients receiving it through the event channel
+	void HandleGameplayEvent(const FFGGameplayEvent& Event);
 #pragma endregion
 private:
 	FGNetMovement MovementToUpdate;
 	FGNetMovement CurrentMovement;
+
+	void SendMovementBatch();
+
+	FFGNetMovementBatch SentMovementHistory;
+	float MovementSendTimer = 0.0f;
+	float LastRelayedMovementTime = -1.0f;
+	int32 NumUnsentMoves = 0;
+	static const int32 MaxMovesPerBatch = 32;
 	const float SmoothTransitionSpeed = 2.5f;
 
 #pragma region Week 2 - Pickup and Rocket
@@ -153,22 +378,40 @@ private:
 
 	FVector GetRocketStartLocation() const;
 
-	AFGRocket* GetFreeRocket() const;
+	UFGProjectileSubsystem* GetProjectileSubsystem() const;
 
+	void StartRocket(const FFGFireEvent& FireEvent);
+	void ReceiveFireEvent(const FFGFireEvent& FireEvent);
+
+	// Returns false if the shot has already been started on this machine
+	bool MarkShotSeen(uint16 ShotSequence);
+
+	// Rockets are pooled and not replicated, a shot is identified by its shooter and shot sequence
 	UFUNCTION(Server, Reliable)
-	void Server_FireRocket(AFGRocket* Newrocket, const FVector& RocketStartLocation, const FRotator& RocketFacingRotation);
+	void Server_FireRocket(const FFGFireEvent& FireEvent);
+
+	void HandleRocketDetonated(uint16 ShotSequence, const FVector& Location);
+	void HandleRocketRejected(uint16 ShotSequence);
+
+	// Shots still in flight on the server, so late joiners and clients that lost the fire event can rebuild them
+	UPROPERTY(ReplicatedUsing = OnRep_ActiveShots)
+	TArray<FFGFireEvent> ActiveShots;
 
-	UFUNCTION(NetMulticast, Reliable)
-	void Multicast_FireRocket(AFGRocket* Newrocket, const FVector& RocketStartLocation, const FRotator& RocketFacingRotation, int32 rocketFired);
+	UFUNCTION()
+	void OnRep_ActiveShots();
 
-	UFUNCTION(Client, Reliable)
-	void Client_RemoveRocket(AFGRocket* RocketToRemove);
+	uint16 LatestSeenShotSequence = 0;
+	uint32 SeenShotMask = 0;
+	bool bHasSeenShot = false;
+
+	// The server trusts the client's fire time this far back, so the shooter's rocket is where they saw it
+	UPROPERTY(EditAnywhere, Category = Weapon)
+	float MaxFireRewindTime = 0.25f;
 
 	UFUNCTION(BlueprintCallable)
 	void Cheat_IncreaseRockets(int32 InNumRockets);
 
-	UPROPERTY(Replicated, Transient)
-	TArray<AFGRocket*> RocketInstances;
+	uint16 NextShotSequence = 0;
 
 	UPROPERTY(EditAnywhere, Category = Weapon)
 	TSubclassOf<AFGRocket> RocketClass;
@@ -216,7 +459,7 @@ private:
 	bool bBrake = false;
 
 #pragma region Week3 - Improve movement
-	void AddMovementVelocity(float DeltaTime);
+	void AddMovementVelocity(float DeltaTime, float InForward);
 
 	float ClientTimeStamp = 0.0f;
 	float ServerTimeStamp = 0.0f;
@@ -229,6 +472,43 @@ private:
 	FRotator OriginalMeshRotation = FRotator::ZeroRotator;
 #pragma endregion
 
+	FFGSnapshotBuffer SnapshotBuffer;
+
+	int32 LagCompensationSlot = INDEX_NONE;
+	int32 MovementRelaySlot = INDEX_NONE;
+
+	void RelayMovement(const FGNetMovement& MovementData);
+
+#pragma region Client Prediction / Server Reconciliation
+	void SimulateMove(const FFGMoveCommand& Command);
+	void ProcessMoveCommand(const FFGMoveCommand& Command);
+	void ReconcileMoves(const FFGMoveCorrection& Correction);
+	FGNetMovement CreateNetMovement(float TimeStamp) const;
+
+	void SaveMove(const FFGMoveCommand& Command);
+	void RemoveAcknowledgedMoves(uint16 AckedSequence);
+	FFGSavedMove& GetSavedMove(int32 Index) { return SavedMoves[(SavedMoveHead + Index) & (MaxSavedMoves - 1)]; }
+
+	static bool IsMoveSequenceNewer(uint16 A, uint16 B) { return static_cast<int16>(A - B) > 0; }
+
+	// Must be a power of two
+	static const int32 MaxSavedMoves = 64;
+	FFGSavedMove SavedMoves[MaxSavedMoves];
+	int32 SavedMoveHead = 0;
+	int32 NumSavedMoves = 0;
+
+	uint16 NextMoveSequence = 1;
+	uint16 LastAckedMoveSequence = 0;
+
+	// Server side state of the last processed command
+	uint16 LastProcessedMoveSequence = 0;
+	float LastProcessedMoveTimeStamp = 0.0f;
+	bool bHasProcessedMove = false;
+	bool bPendingMoveAck = false;
+	// Simulated time the client may still spend, refilled by the server's frame time and spent by every processed command
+	float MoveTimeBudget = 0.0f;
+#pragma endregion
+
 	UPROPERTY(VisibleDefaultsOnly, Category = Collision)
 	USphereComponent* CollisionComponent;
 
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGPlayerController.h"
+#include "Engine/World.h"
+#include "../Network/FGMovementRelaySubsystem.h"
+#include "../Components/FGGameplayEventComponent.h"
+
+AFGPlayerController::AFGPlayerController()
+{
+	GameplayEventComponent = CreateDefaultSubobject<UFGGameplayEventComponent>(TEXT("GameplayEventComponent"));
+}
+
+void AFGPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority())
+	{
+		if (UFGMovementRelaySubsystem* MovementRelay = GetWorld()->GetSubsystem<UFGMovementRelaySubsystem>())
+		{
+			MovementRelaySlot = MovementRelay->RegisterReceiver(this);
+		}
+	}
+}
+
+void AFGPlayerController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	if (MovementRelaySlot != INDEX_NONE)
+	{
+		if (UFGMovementRelaySubsystem* MovementRelay = GetWorld()->GetSubsystem<UFGMovementRelaySubsystem>())
+		{
+			MovementRelay->UnregisterReceiver(this);
+		}
+		MovementRelaySlot = INDEX_NONE;
+	}
+}
+
+void AFGPlayerController::Client_ReceiveRelayedMovement_Implementation(AFGPlayer* Source, const FGNetMovement& MovementData)
+{
+	// The source may not be relevant to us (yet), in which case its reference does not resolve
+	if (Source != nullptr)
+	{
+		Source->ReceiveMovement(MovementData);
+	}
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/PlayerController.h"
+#include "FGPlayer.h"
+#include "FGPlayerController.generated.h"
+
+class UFGGameplayEventComponent;
+
+/**
+ * Per connection state that has to outlive the connection's pawn, so dead players and spectators keep receiving it.
+ */
+UCLASS()
+class FGNET_API AFGPlayerController : public APlayerController
+{
+	GENERATED_BODY()
+
+public:
+	AFGPlayerController();
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Called on this connection with the movement of a player the server relays to it
+	UFUNCTION(Client, Unreliable)
+	void Client_ReceiveRelayedMovement(AFGPlayer* Source, const FGNetMovement& MovementData);
+
+	int32 GetMovementRelaySlot() const { return MovementRelaySlot; }
+
+	UFGGameplayEventComponent* GetGameplayEventComponent() const { return GameplayEventComponent; }
+
+private:
+	int32 MovementRelaySlot = INDEX_NONE;
+
+	UPROPERTY(VisibleDefaultsOnly, Category = Network)
+	UFGGameplayEventComponent* GameplayEventComponent;
+};
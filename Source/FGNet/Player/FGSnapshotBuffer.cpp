@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGSnapshotBuffer.h"
+#include "../FGNetQuantization.h"
+
+void FFGSnapshotBuffer::AddSnapshot(float WrappedTime, const FVector& Location, float Yaw)
+{
+	Stats.NumSnapshotsReceived++;
+
+	float Time = WrappedTime;
+	if (NumSnapshots > 0)
+	{
+		const FFGSnapshot& Newest = GetSnapshot(NumSnapshots - 1);
+		Time = Newest.Time + FFGNetQuantization::GetWrappedTimeDelta(WrappedTime, LatestWrappedTime);
+
+		// Out of order, the buffer only grows at the end so this one is of no use anymore
+		if (Time <= Newest.Time)
+		{
+			Stats.NumLateSnapshots++;
+			return;
+		}
+	}
+
+	if (bHasRenderTime && Time < RenderTime)
+	{
+		Stats.NumLateSnapshots++;
+	}
+
+	if (NumSnapshots == MaxSnapshots)
+	{
+		Head = (Head + 1) & (MaxSnapshots - 1);
+		NumSnapshots--;
+	}
+
+	FFGSnapshot& Snapshot = Snapshots[(Head + NumSnapshots++) & (MaxSnapshots - 1)];
+	Snapshot.Time = Time;
+	Snapshot.Location = Location;
+	Snapshot.Yaw = Yaw;
+
+	LatestWrappedTime = WrappedTime;
+}
+
+bool FFGSnapshotBuffer::Sample(float DeltaTime, float InterpolationDelay, float MaxExtrapolationTime, FVector& OutLocation, float& OutYaw)
+{
+	if (NumSnapshots == 0)
+		return false;
+
+	const FFGSnapshot& Newest = GetSnapshot(NumSnapshots - 1);
+	const float TargetTime = Newest.Time - InterpolationDelay;
+
+	// Keep the render clock at the wanted delay: jump forward when far behind, otherwise speed up or slow down slightly so motion stays continuous.
+	// Never jump backwards, during a stall the clock is held at the extrapolation limit and the slow down catches up once snapshots arrive again.
+	const float Drift = TargetTime - (RenderTime + DeltaTime);
+	if (!bHasRenderTime || Drift > FMath::Max(InterpolationDelay * 2.0f, 0.1f))
+	{
+		RenderTime = TargetTime;
+		bHasRenderTime = true;
+	}
+	else
+	{
+		const float TimeScale = 1.0f + FMath::Clamp(Drift / FMath::Max(InterpolationDelay, KINDA_SMALL_NUMBER), -0.1f, 0.1f);
+		RenderTime = FMath::Min(RenderTime + DeltaTime * TimeScale, Newest.Time + MaxExtrapolationTime);
+	}
+
+	Stats.BufferedTime = Newest.Time - RenderTime;
+
+	if (RenderTime <= Newest.Time)
+	{
+		bIsExtrapolating = false;
+
+		for (int32 Index = NumSnapshots - 1; Index > 0; --Index)
+		{
+			const FFGSnapshot& From = GetSnapshot(Index - 1);
+			if (From.Time <= RenderTime)
+			{
+				const FFGSnapshot& To = GetSnapshot(Index);
+				const float Alpha = FMath::Clamp((RenderTime - From.Time) / (To.Time - From.Time), 0.0f, 1.0f);
+				OutLocation = FMath::Lerp(From.Location, To.Location, Alpha);
+				OutYaw = From.Yaw + FMath::FindDeltaAngleDegrees(From.Yaw, To.Yaw) * Alpha;
+				return true;
+			}
+		}
+
+		// Render time is older than everything we have
+		const FFGSnapshot& Oldest = GetSnapshot(0);
+		OutLocation = Oldest.Location;
+		OutYaw = Oldest.Yaw;
+		return true;
+	}
+
+	// Nothing new arrived in time, dead reckon from the last two snapshots but never further than MaxExtrapolationTime
+	if (!bIsExtrapolating)
+	{
+		Stats.NumUnderruns++;
+		bIsExtrapolating = true;
+	}
+	Stats.TotalExtrapolatedTime += DeltaTime;
+
+	OutLocation = Newest.Location;
+	OutYaw = Newest.Yaw;
+
+	if (NumSnapshots >= 2)
+	{
+		const FFGSnapshot& Previous = GetSnapshot(NumSnapshots - 2);
+		const float SnapshotDelta = Newest.Time - Previous.Time;
+		if (SnapshotDelta > KINDA_SMALL_NUMBER)
+		{
+			const float ExtrapolationTime = FMath::Min(RenderTime - Newest.Time, MaxExtrapolationTime);
+			const FVector Velocity = (Newest.Location - Previous.Location) / SnapshotDelta;
+			OutLocation += Velocity * ExtrapolationTime;
+		}
+	}
+
+	return true;
+}
+
+void FFGSnapshotBuffer::Reset()
+{
+	Head = 0;
+	NumSnapshots = 0;
+	RenderTime = 0.0f;
+	bHasRenderTime = false;
+	bIsExtrapolating = false;
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FGSnapshotBuffer.generated.h"
+
+USTRUCT(BlueprintType)
+struct FFGSnapshotBufferStats
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(BlueprintReadOnly, Category = Network)
+	int32 NumSnapshotsReceived = 0;
+
+	// Snapshots that arrived after we had already rendered past them
+	UPROPERTY(BlueprintReadOnly, Category = Network)
+	int32 NumLateSnapshots = 0;
+
+	// Times the render time ran past the newest snapshot and we had to extrapolate
+	UPROPERTY(BlueprintReadOnly, Category = Network)
+	int32 NumUnderruns = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = Network)
+	float TotalExtrapolatedTime = 0.0f;
+
+	// How far ahead of the render time the newest snapshot currently is
+	UPROPERTY(BlueprintReadOnly, Category = Network)
+	float BufferedTime = 0.0f;
+};
+
+struct FFGSnapshot
+{
+	float Time = 0.0f;
+	FVector Location = FVector::ZeroVector;
+	float Yaw = 0.0f;
+};
+
+/**
+ * Time indexed buffer of received movement, rendered a fixed delay behind the newest sample.
+ * Times are in the sender's clock; wrapped network times are unwrapped against the newest snapshot.
+ */
+class FGNET_API FFGSnapshotBuffer
+{
+public:
+	void AddSnapshot(float WrappedTime, const FVector& Location, float Yaw);
+
+	// Advances the render time and returns false until there is something to render
+	bool Sample(float DeltaTime, float InterpolationDelay, float MaxExtrapolationTime, FVector& OutLocation, float& OutYaw);
+
+	void Reset();
+
+	const FFGSnapshotBufferStats& GetStats() const { return Stats; }
+
+private:
+	const FFGSnapshot& GetSnapshot(int32 Index) const { return Snapshots[(Head + Index) & (MaxSnapshots - 1)]; }
+
+	// Must be a power of two
+	static const int32 MaxSnapshots = 32;
+	FFGSnapshot Snapshots[MaxSnapshots];
+	int32 Head = 0;
+	int32 NumSnapshots = 0;
+
+	float LatestWrappedTime = 0.0f;
+	float RenderTime = 0.0f;
+	bool bHasRenderTime = false;
+	bool bIsExtrapolating = false;
+
+	FFGSnapshotBufferStats Stats;
+};
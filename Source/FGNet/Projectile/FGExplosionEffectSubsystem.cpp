@@ -0,0 +1,307 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGExplosionEffectSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "../FGNet.h"
+
+DECLARE_STATS_GROUP(TEXT("FGEffects"), STATGROUP_FGEffects, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Explosions"), STAT_FGActiveExplosions, STATGROUP_FGEffects);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pending Explosions"), STAT_FGPendingExplosions, STATGROUP_FGEffects);
+DECLARE_CYCLE_STAT(TEXT("Spawn Explosion"), STAT_FGSpawnExplosion, STATGROUP_FGEffects);
+
+void UFGExplosionEffectSubsystem::Deinitialize()
+{
+	for (UParticleSystemComponent* Component : ActiveEffects)
+	{
+		if (IsValid(Component))
+		{
+			Component->DestroyComponent();
+		}
+	}
+
+	for (UParticleSystemComponent* Component : FreeEffects)
+	{
+		if (IsValid(Component))
+		{
+			Component->DestroyComponent();
+		}
+	}
+
+	ActiveEffects.Reset();
+	ActiveEffectStartTimes.Reset();
+	FreeEffects.Reset();
+	PendingRequests.Reset();
+
+	Super::Deinitialize();
+}
+
+void UFGExplosionEffectSubsystem::Tick(float DeltaTime)
+{
+	SET_DWORD_STAT(STAT_FGActiveExplosions, ActiveEffects.Num());
+	SET_DWORD_STAT(STAT_FGPendingExplosions, PendingRequests.Num());
+
+	if (PendingRequests.Num() == 0)
+		return;
+
+	GatherLocalViews();
+
+	const float Time = GetWorld()->GetTimeSeconds();
+	const bool bOverBudget = PendingRequests.Num() > MaxSpawnsPerFrame;
+
+	int32 NumSpawnedThisFrame = 0;
+	int32 NumKept = 0;
+	for (int32 Index = 0; Index < PendingRequests.Num(); ++Index)
+	{
+		const FFGExplosionRequest Request = PendingRequests[Index];
+
+		if (!IsInRangeOfLocalView(Request.Location))
+		{
+			NumEffectsCulled++;
+			continue;
+		}
+
+		// Only worth losing effects over when there are more than the budget allows anyway
+		if (bOverBudget)
+		{
+			if (!IsVisibleToLocalView(Request.Location))
+			{
+				NumEffectsCulled++;
+				continue;
+			}
+
+			if (CanMergeWithActiveEffect(Request, Time))
+			{
+				NumEffectsMerged++;
+				continue;
+			}
+		}
+
+		if (NumSpawnedThisFrame < MaxSpawnsPerFrame)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_FGSpawnExplosion);
+
+			UParticleSystemComponent* Component = AcquireEffect(Request.Template);
+			if (Component == nullptr)
+			{
+				NumEffectsDropped++;
+				continue;
+			}
+
+			Component->SetWorldLocationAndRotation(Request.Location, Request.Rotation);
+			Component->ActivateSystem(true);
+
+			ActiveEffects.Add(Component);
+			ActiveEffectStartTimes.Add(Time);
+			NumSpawnedThisFrame++;
+			NumEffectsSpawned++;
+		}
+		else if (Time - Request.RequestTime < MaxRequestAge)
+		{
+			PendingRequests[NumKept++] = Request;
+		}
+		else
+		{
+			NumEffectsDropped++;
+		}
+	}
+
+	PendingRequests.SetNum(NumKept, false);
+}
+
+bool UFGExplosionEffectSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->IsGameWorld() && World->GetNetMode() != NM_DedicatedServer;
+}
+
+TStatId UFGExplosionEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFGExplosionEffectSubsystem, STATGROUP_Tickables);
+}
+
+void UFGExplosionEffectSubsystem::SpawnExplosion(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	if (Template == nullptr || !IsTickable())
+		return;
+
+	FFGExplosionRequest& Request = PendingRequests.AddDefaulted_GetRef();
+	Request.Template = Template;
+	Request.Location = Location;
+	Request.Rotation = Rotation;
+	Request.RequestTime = GetWorld()->GetTimeSeconds();
+}
+
+void UFGExplosionEffectSubsystem::GatherLocalViews()
+{
+	LocalViews.Reset();
+
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController == nullptr || !PlayerController->IsLocalController())
+			continue;
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		// Explosions are large, widen the cone so ones just off screen still count as visible
+		const float FOV = PlayerController->PlayerCameraManager != nullptr ? PlayerController->PlayerCameraManager->GetFOVAngle() : 90.0f;
+		const float HalfAngle = FMath::Min(FOV * 0.5f + 20.0f, 180.0f);
+
+		FFGEffectView& View = LocalViews.AddDefaulted_GetRef();
+		View.Location = ViewLocation;
+		View.Direction = ViewRotation.Vector();
+		View.CosHalfFOV = FMath::Cos(FMath::DegreesToRadians(HalfAngle));
+	}
+}
+
+bool UFGExplosionEffectSubsystem::IsInRangeOfLocalView(const FVector& Location) const
+{
+	for (const FFGEffectView& View : LocalViews)
+	{
+		if (FVector::DistSquared(Location, View.Location) <= FMath::Square(EffectCullDistance))
+			return true;
+	}
+
+	return false;
+}
+
+bool UFGExplosionEffectSubsystem::IsVisibleToLocalView(const FVector& Location) const
+{
+	for (const FFGEffectView& View : LocalViews)
+	{
+		const FVector ToLocation = Location - View.Location;
+		const float DistanceSquared = ToLocation.SizeSquared();
+		if (DistanceSquared > FMath::Square(EffectCullDistance))
+			continue;
+
+		if (FVector::DotProduct(ToLocation, View.Direction) >= View.CosHalfFOV * FMath::Sqrt(DistanceSquared))
+			return true;
+	}
+
+	return false;
+}
+
+bool UFGExplosionEffectSubsystem::CanMergeWithActiveEffect(const FFGExplosionRequest& Request, float Time) const
+{
+	for (int32 Index = 0; Index < ActiveEffects.Num(); ++Index)
+	{
+		if (Time - ActiveEffectStartTimes[Index] > MergeWindow)
+			continue;
+
+		const UParticleSystemComponent* Component = ActiveEffects[Index];
+		if (Component->Template == Request.Template && FVector::DistSquared(Component->GetComponentLocation(), Request.Location) <= FMath::Square(MergeDistance))
+			return true;
+	}
+
+	return false;
+}
+
+UParticleSystemComponent* UFGExplosionEffectSubsystem::AcquireEffect(UParticleSystem* Template)
+{
+	// A component that last played the same template keeps its emitter instances, switching templates rebuilds them
+	for (int32 Index = FreeEffects.Num() - 1; Index >= 0; --Index)
+	{
+		if (FreeEffects[Index]->Template == Template)
+		{
+			UParticleSystemComponent* Component = FreeEffects[Index];
+			FreeEffects.RemoveAtSwap(Index, 1, false);
+			return Component;
+		}
+	}
+
+	if (ActiveEffects.Num() + FreeEffects.Num() < MaxPooledEffects)
+	{
+		UWorld* World = GetWorld();
+		UParticleSystemComponent* Component = NewObject<UParticleSystemComponent>(World->GetWorldSettings());
+		Component->bAutoDestroy = false;
+		Component->bAutoActivate = false;
+		Component->SetUsingAbsoluteLocation(true);
+		Component->SetUsingAbsoluteRotation(true);
+		Component->SetUsingAbsoluteScale(true);
+		Component->SetTemplate(Template);
+		Component->OnSystemFinished.AddDynamic(this, &UFGExplosionEffectSubsystem::OnEffectFinished);
+		Component->RegisterComponentWithWorld(World);
+
+		NumEffectsCreated++;
+		return Component;
+	}
+
+	if (FreeEffects.Num() > 0)
+	{
+		UParticleSystemComponent* Component = FreeEffects.Pop(false);
+		Component->SetTemplate(Template);
+		return Component;
+	}
+
+	return nullptr;
+}
+
+void UFGExplosionEffectSubsystem::OnEffectFinished(UParticleSystemComponent* Component)
+{
+	const int32 Index = ActiveEffects.Find(Component);
+	if (Index == INDEX_NONE)
+		return;
+
+	ActiveEffects.RemoveAtSwap(Index, 1, false);
+	ActiveEffectStartTimes.RemoveAtSwap(Index, 1, false);
+	FreeEffects.Add(Component);
+}
+
+#if !UE_BUILD_SHIPPING
+void UFGExplosionEffectSubsystem::LogStats() const
+{
+	UE_LOG(LogFGNet, Log, TEXT("Explosions: %d active, %d free, %d components created. Spawned %d, culled %d, merged %d, dropped %d"),
+		ActiveEffects.Num(), FreeEffects.Num(), NumEffectsCreated, NumEffectsSpawned, NumEffectsCulled, NumEffectsMerged, NumEffectsDropped);
+}
+
+// FGNet.Effects.Stats
+static FAutoConsoleCommandWithWorld ExplosionEffectStatsCommand(
+	TEXT("FGNet.Effects.Stats"),
+	TEXT("Logs the explosion effect pool and how many requested effects were spawned, culled, merged or dropped."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		const UFGExplosionEffectSubsystem* EffectSubsystem = World != nullptr ? World->GetSubsystem<UFGExplosionEffectSubsystem>() : nullptr;
+		if (EffectSubsystem == nullptr)
+			return;
+
+		EffectSubsystem->LogStats();
+	}));
+
+// FGNet.Effects.Burst <Template> [NumExplosions] [Radius]
+static FAutoConsoleCommandWithWorldAndArgs ExplosionEffectBurstCommand(
+	TEXT("FGNet.Effects.Burst"),
+	TEXT("Requests many explosions in one frame around the first local player, to check the spawn budget. Args: <ParticleSystemPath> [NumExplosions=50] [Radius=1500]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UFGExplosionEffectSubsystem* EffectSubsystem = World != nullptr ? World->GetSubsystem<UFGExplosionEffectSubsystem>() : nullptr;
+		const APlayerController* PlayerController = World != nullptr ? World->GetFirstPlayerController() : nullptr;
+		if (EffectSubsystem == nullptr || PlayerController == nullptr || PlayerController->GetPawn() == nullptr || Args.Num() == 0)
+			return;
+
+		UParticleSystem* Template = LoadObject<UParticleSystem>(nullptr, *Args[0]);
+		if (Template == nullptr)
+		{
+			UE_LOG(LogFGNet, Warning, TEXT("FGNet.Effects.Burst: could not load particle system %s"), *Args[0]);
+			return;
+		}
+
+		const int32 NumExplosions = Args.Num() > 1 ? FCString::Atoi(*Args[1]) : 50;
+		const float Radius = Args.Num() > 2 ? FCString::Atof(*Args[2]) : 1500.0f;
+		const FVector Center = PlayerController->GetPawn()->GetActorLocation();
+
+		for (int32 Index = 0; Index < NumExplosions; ++Index)
+		{
+			const FVector Offset = FVector(FMath::RandPointInCircle(Radius), 0.0f);
+			EffectSubsystem->SpawnExplosion(Template, Center + Offset, FRotator::ZeroRotator);
+		}
+	}));
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "FGExplosionEffectSubsystem.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+
+/**
+ * Plays explosion effects from a pool of particle components instead of spawning an auto destroying component for
+ * every detonation. Requests are queued and spawned at the end of the frame under a per-frame budget. Effects too far
+ * from every local view are never spawned, and once a frame asks for more than the budget, effects outside the view
+ * or close to one already playing are dropped first.
+ */
+UCLASS(config = Game)
+class FGNET_API UFGExplosionEffectSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+#pragma region FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+#pragma endregion
+
+	void SpawnExplosion(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation);
+
+	int32 GetNumActiveEffects() const { return ActiveEffects.Num(); }
+	int32 GetNumFreeEffects() const { return FreeEffects.Num(); }
+
+#if !UE_BUILD_SHIPPING
+	void LogStats() const;
+#endif // !UE_BUILD_SHIPPING
+
+	UPROPERTY(Config)
+	int32 MaxSpawnsPerFrame = 4;
+
+	// Upper bound on particle components, playing and free together
+	UPROPERTY(Config)
+	int32 MaxPooledEffects = 32;
+
+	// Effects further away from every local view than this are not spawned at all
+	UPROPERTY(Config)
+	float EffectCullDistance = 15000.0f;
+
+	// Under load, an effect this close to one of the same kind started within MergeWindow is not spawned
+	UPROPERTY(Config)
+	float MergeDistance = 300.0f;
+
+	UPROPERTY(Config)
+	float MergeWindow = 0.2f;
+
+	// Requests still waiting for budget after this long are dropped, a late explosion looks worse than none
+	UPROPERTY(Config)
+	float MaxRequestAge = 0.1f;
+
+private:
+	struct FFGExplosionRequest
+	{
+		UParticleSystem* Template;
+		FVector Location;
+		FRotator Rotation;
+		float RequestTime;
+	};
+
+	struct FFGEffectView
+	{
+		FVector Location;
+		FVector Direction;
+		float CosHalfFOV;
+	};
+
+	void GatherLocalViews();
+	bool IsInRangeOfLocalView(const FVector& Location) const;
+	bool IsVisibleToLocalView(const FVector& Location) const;
+	bool CanMergeWithActiveEffect(const FFGExplosionRequest& Request, float Time) const;
+	UParticleSystemComponent* AcquireEffect(UParticleSystem* Template);
+
+	UFUNCTION()
+	void OnEffectFinished(UParticleSystemComponent* Component);
+
+	TArray<FFGExplosionRequest> PendingRequests;
+	TArray<FFGEffectView> LocalViews;
+
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> ActiveEffects;
+	TArray<float> ActiveEffectStartTimes;
+
+	UPROPERTY(Transient)
+	TArray<UParticleSystemComponent*> FreeEffects;
+
+	int32 NumEffectsCreated = 0;
+	int32 NumEffectsSpawned = 0;
+	int32 NumEffectsCulled = 0;
+	int32 NumEffectsMerged = 0;
+	int32 NumEffectsDropped = 0;
+};
@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGProjectileHitTest.h"
+#include "Math/VectorRegister.h"
+
+void FFGHitSpheres::Reset()
+{
+	X.Reset();
+	Y.Reset();
+	Z.Reset();
+	RadiusSquared.Reset();
+	Actors.Reset();
+}
+
+void FFGHitSpheres::Add(const FVector& Center, float Radius, AActor* Actor)
+{
+	const int32 Index = Actors.Add(Actor);
+
+	// Grow a whole register at a time, unused lanes stay zero and are masked out when testing
+	if (Index >= X.Num())
+	{
+		X.AddZeroed(4);
+		Y.AddZeroed(4);
+		Z.AddZeroed(4);
+		RadiusSquared.AddZeroed(4);
+	}
+
+	X[Index] = Center.X;
+	Y[Index] = Center.Y;
+	Z[Index] = Center.Z;
+	RadiusSquared[Index] = FMath::Square(Radius);
+}
+
+/*
+ * Segment S(t) = Start + Delta * t for t in [0, 1] against a sphere at C with radius r:
+ *   M = Start - C, A = |Delta|^2, B = M.Delta, C = |M|^2 - r^2
+ *   the segment enters the sphere at t = (-B - sqrt(B^2 - A*C)) / A, and starts inside of it when C <= 0.
+ */
+int32 FFGProjectileHitTest::SegmentVsSpheres(const FVector& Start, const FVector& End, const FFGHitSpheres& Spheres, const AActor* IgnoredActor, float& OutTime)
+{
+	const FVector Delta = End - Start;
+	const float A = Delta.SizeSquared();
+	if (A < SMALL_NUMBER)
+		return INDEX_NONE;
+
+	const VectorRegister StartX = VectorSetFloat1(Start.X);
+	const VectorRegister StartY = VectorSetFloat1(Start.Y);
+	const VectorRegister StartZ = VectorSetFloat1(Start.Z);
+	const VectorRegister DeltaX = VectorSetFloat1(Delta.X);
+	const VectorRegister DeltaY = VectorSetFloat1(Delta.Y);
+	const VectorRegister DeltaZ = VectorSetFloat1(Delta.Z);
+	const VectorRegister VectorA = VectorSetFloat1(A);
+	const VectorRegister InverseA = VectorSetFloat1(1.0f / A);
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister One = VectorOne();
+	const VectorRegister Tiny = VectorSetFloat1(SMALL_NUMBER);
+
+	alignas(16) float Times[4];
+	int32 BestIndex = INDEX_NONE;
+	float BestTime = MAX_flt;
+
+	const int32 NumSpheres = Spheres.Num();
+	for (int32 Base = 0; Base < NumSpheres; Base += 4)
+	{
+		const VectorRegister MX = VectorSubtract(StartX, VectorLoadAligned(&Spheres.X[Base]));
+		const VectorRegister MY = VectorSubtract(StartY, VectorLoadAligned(&Spheres.Y[Base]));
+		const VectorRegister MZ = VectorSubtract(StartZ, VectorLoadAligned(&Spheres.Z[Base]));
+
+		const VectorRegister B = VectorMultiplyAdd(MX, DeltaX, VectorMultiplyAdd(MY, DeltaY, VectorMultiply(MZ, DeltaZ)));
+		const VectorRegister C = VectorSubtract(VectorMultiplyAdd(MX, MX, VectorMultiplyAdd(MY, MY, VectorMultiply(MZ, MZ))), VectorLoadAligned(&Spheres.RadiusSquared[Base]));
+		const VectorRegister Discriminant = VectorSubtract(VectorMultiply(B, B), VectorMultiply(VectorA, C));
+
+		const VectorRegister ClampedDiscriminant = VectorMax(Discriminant, Tiny);
+		const VectorRegister SqrtDiscriminant = VectorMultiply(ClampedDiscriminant, VectorReciprocalSqrtAccurate(ClampedDiscriminant));
+		const VectorRegister EnterTime = VectorMultiply(VectorSubtract(VectorNegate(B), SqrtDiscriminant), InverseA);
+
+		const VectorRegister StartsInside = VectorCompareGE(Zero, C);
+		const VectorRegister Enters = VectorBitwiseAnd(VectorCompareGE(Discriminant, Zero), VectorBitwiseAnd(VectorCompareGE(EnterTime, Zero), VectorCompareGE(One, EnterTime)));
+
+		int32 HitMask = VectorMaskBits(VectorBitwiseOr(StartsInside, Enters));
+		if (HitMask == 0)
+			continue;
+
+		// Padding lanes are zero sized spheres at the origin and must never count
+		HitMask &= (1 << FMath::Min(NumSpheres - Base, 4)) - 1;
+
+		VectorStoreAligned(VectorSelect(StartsInside, Zero, EnterTime), Times);
+		while (HitMask != 0)
+		{
+			const int32 Lane = FMath::CountTrailingZeros(HitMask);
+			HitMask &= HitMask - 1;
+
+			const int32 Index = Base + Lane;
+			if (Spheres.Actors[Index] != IgnoredActor && Times[Lane] < BestTime)
+			{
+				BestTime = Times[Lane];
+				BestIndex = Index;
+			}
+		}
+	}
+
+	OutTime = BestTime;
+	return BestIndex;
+}
+
+int32 FFGProjectileHitTest::SegmentVsSpheresScalar(const FVector& Start, const FVector& End, const FFGHitSpheres& Spheres, const AActor* IgnoredActor, float& OutTime)
+{
+	const FVector Delta = End - Start;
+	const float A = Delta.SizeSquared();
+	if (A < SMALL_NUMBER)
+		return INDEX_NONE;
+
+	int32 BestIndex = INDEX_NONE;
+	float BestTime = MAX_flt;
+
+	for (int32 Index = 0; Index < Spheres.Num(); ++Index)
+	{
+		if (Spheres.Actors[Index] == IgnoredActor)
+			continue;
+
+		const FVector M = Start - FVector(Spheres.X[Index], Spheres.Y[Index], Spheres.Z[Index]);
+		const float B = FVector::DotProduct(M, Delta);
+		const float C = M.SizeSquared() - Spheres.RadiusSquared[Index];
+
+		float Time;
+		if (C <= 0.0f)
+		{
+			Time = 0.0f;
+		}
+		else
+		{
+			const float Discriminant = B * B - A * C;
+			if (Discriminant < 0.0f)
+				continue;
+
+			Time = (-B - FMath::Sqrt(Discriminant)) / A;
+			if (Time < 0.0f || Time > 1.0f)
+				continue;
+		}
+
+		if (Time < BestTime)
+		{
+			BestTime = Time;
+			BestIndex = Index;
+		}
+	}
+
+	OutTime = BestTime;
+	return BestIndex;
+}
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+
+// Collision spheres in structure of arrays form, always padded to a multiple of four so they can be loaded as vector registers.
+struct FGNET_API FFGHitSpheres
+{
+	void Reset();
+	void Add(const FVector& Center, float Radius, AActor* Actor);
+
+	int32 Num() const { return Actors.Num(); }
+
+	TArray<float, TAlignedHeapAllocator<16>> X;
+	TArray<float, TAlignedHeapAllocator<16>> Y;
+	TArray<float, TAlignedHeapAllocator<16>> Z;
+	TArray<float, TAlignedHeapAllocator<16>> RadiusSquared;
+	TArray<AActor*> Actors;
+};
+
+struct FGNET_API FFGProjectileHitTest
+{
+	// Returns the index of the first sphere the segment enters (or starts inside of), INDEX_NONE if none.
+	// OutTime is the fraction along the segment, matching FHitResult::Time of a line trace.
+	static int32 SegmentVsSpheres(const FVector& Start, const FVector& End, const FFGHitSpheres& Spheres, const AActor* IgnoredActor, float& OutTime);
+
+	// Reference implementation, one sphere at a time
+	static int32 SegmentVsSpheresScalar(const FVector& Start, const FVector& End, const FFGHitSpheres& Spheres, const AActor* IgnoredActor, float& OutTime);
+};
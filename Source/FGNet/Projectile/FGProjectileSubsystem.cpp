@@ -0,0 +1,680 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FGProjectileSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "DrawDebugHelpers.h"
+#include "EngineUtils.h"
+#include "HAL/IConsoleManager.h"
+#include "GameFramework/GameStateBase.h"
+#include "../FGRocket.h"
+#include "../Player/FGPlayer.h"
+#include "../FGNet.h"
+#include "../FGNetQuantization.h"
+#include "../Network/FGLagCompensationSubsystem.h"
+
+DECLARE_STATS_GROUP(TEXT("FGProjectiles"), STATGROUP_FGProjectiles, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Active Rockets"), STAT_FGActiveRockets, STATGROUP_FGProjectiles);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pooled Rockets"), STAT_FGPooledRockets, STATGROUP_FGProjectiles);
+DECLARE_CYCLE_STAT(TEXT("Spawn Pooled Rocket"), STAT_FGSpawnPooledRocket, STATGROUP_FGProjectiles);
+
+// Rockets fired less than this long ago are swept from their origin when added, to catch up on hits
+static constexpr float MaxCatchUpSweepTime = 0.5f;
+
+// Rockets turning more than this since the last long world trace need a new one
+static constexpr float WorldTraceDirectionTolerance = 0.9999f;
+
+void UFGProjectileSubsystem::Tick(float DeltaTime)
+{
+	TickPool();
+
+	SET_DWORD_STAT(STAT_FGActiveRockets, Rockets.Num());
+	SET_DWORD_STAT(STAT_FGPooledRockets, NumPooledRockets);
+
+	if (Rockets.Num() == 0)
+	{
+		StepAccumulator = 0.0f;
+		return;
+	}
+
+	// Players only move between frames, so every step this frame tests against the same spheres
+	if (bUseAnalyticHitTest)
+	{
+		GatherPlayerSpheres(PlayerSpheres);
+		WorldQueryParams.ClearIgnoredActors();
+		WorldQueryParams.AddIgnoredActors(PlayerSpheres.Actors);
+	}
+
+	const float ServerTime = GetServerWorldTime();
+
+	float InterpolationAlpha = 1.0f;
+	if (SimulationRate > 0.0f)
+	{
+		const float StepTime = 1.0f / SimulationRate;
+
+		// After a hitch rockets still end up where they should be, the first step just sweeps a longer distance
+		StepAccumulator = FMath::Min(StepAccumulator + DeltaTime, StepTime * MaxStepsPerFrame);
+		while (StepAccumulator >= StepTime && Rockets.Num() > 0)
+		{
+			StepAccumulator -= StepTime;
+			SimulateStep(ServerTime - StepAccumulator);
+		}
+
+		InterpolationAlpha = StepAccumulator / StepTime;
+	}
+	else
+	{
+		SimulateStep(ServerTime);
+	}
+
+	UpdateVisuals(DeltaTime, InterpolationAlpha);
+}
+
+void UFGProjectileSubsystem::SimulateStep(float ServerTime)
+{
+	const int32 NumProjectiles = Rockets.Num();
+	LastStepServerTime = ServerTime;
+
+	for (int32 Index = 0; Index < NumProjectiles; ++Index)
+	{
+		const float TimeSinceFire = FFGNetQuantization::GetWrappedTimeDelta(ServerTime, FireTimes[Index]);
+		PreviousLocations[Index] = Locations[Index];
+		LifeTimesRemaining[Index] = LifeTimes[Index] - TimeSinceFire;
+		DistancesMoved[Index] = Velocities[Index] * FMath::Clamp(TimeSinceFire, 0.0f, LifeTimes[Index]);
+		Locations[Index] = StartLocations[Index] + Directions[Index] * DistancesMoved[Index];
+	}
+
+	// Rockets are removed while their events are handled, so nothing is resolved until every query has been issued
+	UWorld* World = GetWorld();
+	PendingEvents.Reset();
+
+	const bool bIsServer = World->GetNetMode() != NM_Client;
+
+	for (int32 Index = 0; Index < NumProjectiles; ++Index)
+	{
+		AFGRocket* Rocket = Rockets[Index];
+		const FVector& StartLocation = PreviousLocations[Index];
+		const FVector& EndLocation = Locations[Index];
+
+		FHitResult Hit;
+		if (!bUseAnalyticHitTest)
+		{
+			if (World->LineTraceSingleByChannel(Hit, StartLocation, EndLocation, ECC_Visibility, Rocket->CachedCollisionQueryParams))
+			{
+				PendingEvents.Add({ Rocket, Hit.Location, Hit.GetActor() });
+				continue;
+			}
+		}
+		else
+		{
+			float SphereTime;
+			const int32 SphereIndex = FFGProjectileHitTest::SegmentVsSpheres(StartLocation, EndLocation, PlayerSpheres, Rocket->GetOwner(), SphereTime);
+			const FVector SphereHitLocation = SphereIndex != INDEX_NONE ? FMath::Lerp(StartLocation, EndLocation, SphereTime) : EndLocation;
+
+			// Only the part of the segment in front of a player hit can be blocked by world geometry
+			if (IsNearWorldGeometry(Index) && World->LineTraceSingleByChannel(Hit, StartLocation, SphereHitLocation, ECC_Visibility, WorldQueryParams))
+			{
+				PendingEvents.Add({ Rocket, Hit.Location, Hit.GetActor() });
+				continue;
+			}
+
+			if (SphereIndex != INDEX_NONE)
+			{
+				PendingEvents.Add({ Rocket, SphereHitLocation, PlayerSpheres.Actors[SphereIndex] });
+				continue;
+			}
+		}
+
+		// Nothing in the world is in the way here, so a player the shooter saw on the segment counts as hit
+		if (bIsServer && bRewindTargets)
+		{
+			float RewoundTime;
+			if (AActor* RewoundActor = FindRewoundHit(Index, StartLocation, EndLocation, ServerTime, RewoundTime))
+			{
+				PendingEvents.Add({ Rocket, FMath::Lerp(StartLocation, EndLocation, RewoundTime), RewoundActor });
+				continue;
+			}
+		}
+
+		if (LifeTimesRemaining[Index] < 0.0f)
+		{
+			PendingEvents.Add({ Rocket, EndLocation, nullptr });
+		}
+	}
+
+	// Only the server's detonations count, clients get them as a correction to their own
+	for (const FFGProjectileEvent& Event : PendingEvents)
+	{
+		AFGPlayer* Shooter = bIsServer ? Cast<AFGPlayer>(Event.Rocket->GetOwner()) : nullptr;
+		if (Shooter != nullptr)
+		{
+			Shooter->OnRocketDetonated(static_cast<uint16>(Event.Rocket->GetShotId()), Event.Location);
+		}
+
+		Event.Rocket->Explode(Event.Location);
+		if (Event.HitActor != nullptr)
+		{
+			Event.Rocket->ApplyDamage(Event.HitActor);
+		}
+	}
+}
+
+void UFGProjectileSubsystem::UpdateVisuals(float DeltaTime, float InterpolationAlpha)
+{
+	GatherLocalViews();
+
+	HiddenTransformUpdateTimer -= DeltaTime;
+	const bool bUpdateHiddenTransforms = HiddenTransformUpdateTimer <= 0.0f;
+	if (bUpdateHiddenTransforms)
+	{
+		HiddenTransformUpdateTimer = HiddenTransformUpdateInterval;
+	}
+
+	for (int32 Index = 0; Index < Rockets.Num(); ++Index)
+	{
+		AFGRocket* Rocket = Rockets[Index];
+
+		// The simulation runs at its own rate, blend between the last two steps so motion stays smooth on screen
+		VisualOffsets[Index] = FMath::VInterpTo(VisualOffsets[Index], FVector::ZeroVector, DeltaTime, CorrectionSmoothingSpeed);
+		const FVector Location = FMath::Lerp(PreviousLocations[Index], Locations[Index], InterpolationAlpha) + VisualOffsets[Index];
+
+		const bool bVisible = IsVisibleToLocalView(Location);
+		if (bVisible != VisualsVisible[Index])
+		{
+			Rocket->SetRocketVisibility(bVisible);
+			VisualsVisible[Index] = bVisible;
+		}
+
+		if (bVisible || bUpdateHiddenTransforms)
+		{
+			Rocket->SetActorLocation(Location, false, nullptr, ETeleportType::TeleportPhysics);
+		}
+
+#if !UE_BUILD_SHIPPING
+		if (Rocket->bDebugDrawCorrection)
+		{
+			const float ArrowLength = 3000.0f;
+			const float ArrowSize = 50.0f;
+			DrawDebugDirectionalArrow(GetWorld(), StartLocations[Index], StartLocations[Index] + OriginalDirections[Index] * ArrowLength, ArrowSize, FColor::Red);
+			DrawDebugDirectionalArrow(GetWorld(), StartLocations[Index], StartLocations[Index] + Directions[Index] * ArrowLength, ArrowSize, FColor::Green);
+		}
+#endif // !UE_BUILD_SHIPPING
+	}
+}
+
+bool UFGProjectileSubsystem::IsTickable() const
+{
+	const UWorld* World = GetWorld();
+	return World != nullptr && World->IsGameWorld();
+}
+
+TStatId UFGProjectileSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFGProjectileSubsystem, STATGROUP_Tickables);
+}
+
+void UFGProjectileSubsystem::AddProjectile(AFGRocket* Rocket, const FVector& StartLocation, const FVector& Direction, float FireTime, float Velocity, float LifeTime, float TargetRewindTime)
+{
+	if (Rocket->ProjectileIndex != INDEX_NONE)
+	{
+		RemoveProjectile(Rocket);
+	}
+
+	Rocket->ProjectileIndex = Rockets.Add(Rocket);
+	StartLocations.Add(StartLocation);
+	Directions.Add(Direction);
+	OriginalDirections.Add(Direction);
+	FireTimes.Add(FireTime);
+	TargetRewindTimes.Add(TargetRewindTime);
+
+	// Shots learned about late (joining, lost packets) are placed where they already are instead of sweeping the whole
+	// way from the origin, which would hit things the rocket passed long ago
+	const float TimeSinceFire = FFGNetQuantization::GetWrappedTimeDelta(GetServerWorldTime(), FireTime);
+	const float SweepStartDistance = TimeSinceFire > MaxCatchUpSweepTime ? Velocity * FMath::Min(TimeSinceFire, LifeTime) : 0.0f;
+	Locations.Add(StartLocation + Direction * SweepStartDistance);
+	PreviousLocations.Add(StartLocation + Direction * SweepStartDistance);
+	DistancesMoved.Add(SweepStartDistance);
+	Velocities.Add(Velocity);
+	LifeTimes.Add(LifeTime);
+	LifeTimesRemaining.Add(LifeTime);
+	VisualOffsets.Add(FVector::ZeroVector);
+	VisualsVisible.Add(false);
+	WorldHitDistances.Add(0.0f);
+	WorldTraceDirections.Add(Direction);
+	WorldTraceDistances.Add(-MAX_flt);
+}
+
+void UFGProjectileSubsystem::RemoveProjectile(AFGRocket* Rocket)
+{
+	const int32 Index = Rocket->ProjectileIndex;
+	if (Rockets.IsValidIndex(Index) && Rockets[Index] == Rocket)
+	{
+		RemoveAtSwap(Index);
+	}
+	Rocket->ProjectileIndex = INDEX_NONE;
+}
+
+void UFGProjectileSubsystem::ApplyCorrection(AFGRocket* Rocket, const FVector& StartLocation, const FVector& Direction, float FireTime)
+{
+	const int32 Index = Rocket->ProjectileIndex;
+	if (!Rockets.IsValidIndex(Index) || Rockets[Index] != Rocket)
+		return;
+
+	const FVector OldLocation = Locations[Index];
+
+	StartLocations[Index] = StartLocation;
+	Directions[Index] = Direction;
+	FireTimes[Index] = FireTime;
+
+	const float TimeSinceFire = FFGNetQuantization::GetWrappedTimeDelta(LastStepServerTime, FireTime);
+	DistancesMoved[Index] = Velocities[Index] * FMath::Clamp(TimeSinceFire, 0.0f, LifeTimes[Index]);
+	Locations[Index] = StartLocation + Direction * DistancesMoved[Index];
+
+	// The jump itself is not a path the rocket travelled, the next sweep starts on the corrected path
+	PreviousLocations[Index] = Locations[Index];
+	VisualOffsets[Index] += OldLocation - Locations[Index];
+}
+
+float UFGProjectileSubsystem::GetServerWorldTime() const
+{
+	const UWorld* World = GetWorld();
+	const AGameStateBase* GameState = World->GetGameState();
+	return GameState != nullptr && World->GetNetMode() == NM_Client ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+AFGRocket* UFGProjectileSubsystem::AcquireRocket(TSubclassOf<AFGRocket> RocketClass, AActor* Shooter, int32 ShotId)
+{
+	if (RocketClass == nullptr)
+		return nullptr;
+
+	AFGRocket* Rocket = nullptr;
+	for (int32 Index = FreeRockets.Num() - 1; Index >= 0; --Index)
+	{
+		if (FreeRockets[Index]->GetClass() == RocketClass)
+		{
+			Rocket = FreeRockets[Index];
+			FreeRockets.RemoveAt(Index, 1, false);
+			FreeRocketReleaseTimes.RemoveAt(Index, 1, false);
+			break;
+		}
+	}
+
+	if (Rocket == nullptr)
+	{
+		Rocket = SpawnPooledRocket(RocketClass);
+		if (Rocket == nullptr)
+			return nullptr;
+	}
+
+	Rocket->AssignShot(Shooter, ShotId);
+	return Rocket;
+}
+
+void UFGProjectileSubsystem::ReleaseRocket(AFGRocket* Rocket)
+{
+	RemoveProjectile(Rocket);
+
+	if (!FreeRockets.Contains(Rocket))
+	{
+		FreeRockets.Add(Rocket);
+		FreeRocketReleaseTimes.Add(GetWorld()->GetTimeSeconds());
+	}
+}
+
+void UFGProjectileSubsystem::ForgetRocket(AFGRocket* Rocket)
+{
+	RemoveProjectile(Rocket);
+
+	const int32 FreeIndex = FreeRockets.Find(Rocket);
+	if (FreeIndex != INDEX_NONE)
+	{
+		FreeRockets.RemoveAt(FreeIndex, 1, false);
+		FreeRocketReleaseTimes.RemoveAt(FreeIndex, 1, false);
+	}
+
+	if (Rocket->bIsPooled)
+	{
+		Rocket->bIsPooled = false;
+		--NumPooledRockets;
+	}
+}
+
+void UFGProjectileSubsystem::PrewarmPool(TSubclassOf<AFGRocket> RocketClass, int32 NumRockets)
+{
+	if (RocketClass == nullptr)
+		return;
+
+	PrewarmClass = RocketClass;
+	NumRocketsToPrewarm = FMath::Clamp(NumRocketsToPrewarm + NumRockets, 0, FMath::Max(MaxPrewarmedRockets - NumRocketsPrewarmed, 0));
+}
+
+AFGRocket* UFGProjectileSubsystem::FindRocket(const AActor* Shooter, int32 ShotId) const
+{
+	for (AFGRocket* Rocket : Rockets)
+	{
+		if (Rocket->GetOwner() == Shooter && Rocket->GetShotId() == ShotId)
+			return Rocket;
+	}
+	return nullptr;
+}
+
+int32 UFGProjectileSubsystem::GetNumActiveRockets(const AActor* Shooter) const
+{
+	int32 NumActive = 0;
+	for (const AFGRocket* Rocket : Rockets)
+	{
+		if (Rocket->GetOwner() == Shooter)
+			NumActive++;
+	}
+	return NumActive;
+}
+
+void UFGProjectileSubsystem::TickPool()
+{
+	for (int32 Spawned = 0; Spawned < PrewarmSpawnsPerFrame && NumRocketsToPrewarm > 0; ++Spawned)
+	{
+		--NumRocketsToPrewarm;
+		if (AFGRocket* Rocket = SpawnPooledRocket(PrewarmClass))
+		{
+			++NumRocketsPrewarmed;
+			ReleaseRocket(Rocket);
+		}
+	}
+
+	// Release times only grow, so only the front can have been idle long enough
+	const float ShrinkTime = GetWorld()->GetTimeSeconds() - PoolShrinkDelay;
+	while (FreeRockets.Num() > 0 && NumPooledRockets > MinPooledRockets && FreeRocketReleaseTimes[0] < ShrinkTime)
+	{
+		AFGRocket* Rocket = FreeRockets[0];
+		ForgetRocket(Rocket);
+		Rocket->Destroy();
+	}
+}
+
+AFGRocket* UFGProjectileSubsystem::SpawnPooledRocket(TSubclassOf<AFGRocket> RocketClass)
+{
+	SCOPE_CYCLE_COUNTER(STAT_FGSpawnPooledRocket);
+	const double StartTime = FPlatformTime::Seconds();
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags = RF_Transient; // won't save in the level
+	AFGRocket* Rocket = GetWorld()->SpawnActor<AFGRocket>(RocketClass, FTransform::Identity, SpawnParams);
+
+	PoolSpawnTime += FPlatformTime::Seconds() - StartTime;
+
+	if (Rocket != nullptr)
+	{
+		Rocket->bIsPooled = true;
+		++NumPooledRockets;
+	}
+	return Rocket;
+}
+
+void UFGProjectileSubsystem::RemoveAtSwap(int32 Index)
+{
+	Rockets.RemoveAtSwap(Index, 1, false);
+	StartLocations.RemoveAtSwap(Index, 1, false);
+	Directions.RemoveAtSwap(Index, 1, false);
+	OriginalDirections.RemoveAtSwap(Index, 1, false);
+	FireTimes.RemoveAtSwap(Index, 1, false);
+	TargetRewindTimes.RemoveAtSwap(Index, 1, false);
+	Locations.RemoveAtSwap(Index, 1, false);
+	PreviousLocations.RemoveAtSwap(Index, 1, false);
+	DistancesMoved.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	LifeTimes.RemoveAtSwap(Index, 1, false);
+	LifeTimesRemaining.RemoveAtSwap(Index, 1, false);
+	VisualOffsets.RemoveAtSwap(Index, 1, false);
+	VisualsVisible.RemoveAtSwap(Index, 1, false);
+	WorldHitDistances.RemoveAtSwap(Index, 1, false);
+	WorldTraceDirections.RemoveAtSwap(Index, 1, false);
+	WorldTraceDistances.RemoveAtSwap(Index, 1, false);
+
+	if (Rockets.IsValidIndex(Index))
+	{
+		Rockets[Index]->ProjectileIndex = Index;
+	}
+}
+
+void UFGProjectileSubsystem::GatherLocalViews()
+{
+	LocalViews.Reset();
+
+	for (FConstPlayerControllerIterator Iterator = GetWorld()->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController == nullptr || !PlayerController->IsLocalController())
+			continue;
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		// The FOV is horizontal, widen the cone so wide aspect ratios and rockets entering at the edges are covered
+		const float FOV = PlayerController->PlayerCameraManager != nullptr ? PlayerController->PlayerCameraManager->GetFOVAngle() : 90.0f;
+		const float HalfAngle = FMath::Min(FOV * 0.5f + 15.0f, 180.0f);
+
+		FFGProjectileView& View = LocalViews.AddDefaulted_GetRef();
+		View.Location = ViewLocation;
+		View.Direction = ViewRotation.Vector();
+		View.CosHalfFOV = FMath::Cos(FMath::DegreesToRadians(HalfAngle));
+	}
+}
+
+bool UFGProjectileSubsystem::IsVisibleToLocalView(const FVector& Location) const
+{
+	for (const FFGProjectileView& View : LocalViews)
+	{
+		const FVector ToLocation = Location - View.Location;
+		const float DistanceSquared = ToLocation.SizeSquared();
+		if (DistanceSquared > FMath::Square(VisualCullDistance))
+			continue;
+
+		if (FVector::DotProduct(ToLocation, View.Direction) >= View.CosHalfFOV * FMath::Sqrt(DistanceSquared))
+			return true;
+	}
+
+	return false;
+}
+
+void UFGProjectileSubsystem::GatherPlayerSpheres(FFGHitSpheres& OutSpheres) const
+{
+	OutSpheres.Reset();
+
+	for (TActorIterator<AFGPlayer> Iterator(GetWorld()); Iterator; ++Iterator)
+	{
+		AFGPlayer* Player = *Iterator;
+		if (Player->IsCollisionEnabled())
+		{
+			OutSpheres.Add(Player->GetActorLocation(), Player->GetCollisionRadius(), Player);
+		}
+	}
+}
+
+AActor* UFGProjectileSubsystem::FindRewoundHit(int32 Index, const FVector& StartLocation, const FVector& EndLocation, float ServerTime, float& OutTime)
+{
+	const AActor* Shooter = Rockets[Index]->GetOwner();
+	const float TargetRewindTime = TargetRewindTimes[Index];
+	const UFGLagCompensationSubsystem* LagCompensation = GetWorld()->GetSubsystem<UFGLagCompensationSubsystem>();
+	if (Shooter == nullptr || LagCompensation == nullptr || TargetRewindTime <= 0.0f)
+		return nullptr;
+
+	LagCompensation->GatherRewoundSpheres(ServerTime - TargetRewindTime, RewoundSpheres);
+
+	const int32 SphereIndex = FFGProjectileHitTest::SegmentVsSpheres(StartLocation, EndLocation, RewoundSpheres, Shooter, OutTime);
+	return SphereIndex != INDEX_NONE ? RewoundSpheres.Actors[SphereIndex] : nullptr;
+}
+
+bool UFGProjectileSubsystem::IsNearWorldGeometry(int32 Index)
+{
+	// A correction changed the direction, the cached hit is for a path the rocket is no longer on
+	if (FVector::DotProduct(Directions[Index], WorldTraceDirections[Index]) < WorldTraceDirectionTolerance)
+	{
+		WorldTraceDirections[Index] = Directions[Index];
+		WorldTraceDistances[Index] = -MAX_flt;
+		return true;
+	}
+
+	// Refreshed by distance rather than time, so fast rockets and long steps cannot skip past the margin
+	if (DistancesMoved[Index] - WorldTraceDistances[Index] >= FMath::Min(WorldTraceRefreshDistance, WorldTraceMargin))
+	{
+		WorldTraceDistances[Index] = DistancesMoved[Index];
+
+		const FVector& StartLocation = PreviousLocations[Index];
+		const float StartDistance = FVector::DotProduct(StartLocation - StartLocations[Index], Directions[Index]);
+		const float RemainingDistance = DistancesMoved[Index] - StartDistance + Velocities[Index] * FMath::Max(LifeTimesRemaining[Index], 0.0f) + WorldTraceMargin;
+
+		FHitResult Hit;
+		if (GetWorld()->LineTraceSingleByChannel(Hit, StartLocation, StartLocation + Directions[Index] * RemainingDistance, ECC_Visibility, WorldQueryParams))
+		{
+			WorldHitDistances[Index] = StartDistance + Hit.Distance;
+		}
+		else
+		{
+			WorldHitDistances[Index] = MAX_flt;
+		}
+	}
+
+	return DistancesMoved[Index] + WorldTraceMargin >= WorldHitDistances[Index];
+}
+
+#if !UE_BUILD_SHIPPING
+// FGNet.Projectile.PoolStats
+static FAutoConsoleCommandWithWorld ProjectilePoolStatsCommand(
+	TEXT("FGNet.Projectile.PoolStats"),
+	TEXT("Logs the size of the rocket pool, how much memory its actors use and how long spawning them took."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		const UFGProjectileSubsystem* ProjectileSubsystem = World != nullptr ? World->GetSubsystem<UFGProjectileSubsystem>() : nullptr;
+		if (ProjectileSubsystem == nullptr)
+			return;
+
+		ProjectileSubsystem->LogPoolStats();
+	}));
+
+// FGNet.Projectile.HitTestBenchmark [NumSegments] [SegmentLength]
+static FAutoConsoleCommandWithWorldAndArgs ProjectileHitTestBenchmarkCommand(
+	TEXT("FGNet.Projectile.HitTestBenchmark"),
+	TEXT("Compares analytic player sphere hits against physics traces on random segments around the players in the world. Args: [NumSegments=100000] [SegmentLength=200]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const UFGProjectileSubsystem* ProjectileSubsystem = World != nullptr ? World->GetSubsystem<UFGProjectileSubsystem>() : nullptr;
+		if (ProjectileSubsystem == nullptr)
+			return;
+
+		const int32 NumSegments = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 100000;
+		const float SegmentLength = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 200.0f;
+
+		FFGHitSpheres Spheres;
+		ProjectileSubsystem->GatherPlayerSpheres(Spheres);
+		if (Spheres.Num() == 0)
+		{
+			UE_LOG(LogFGNet, Warning, TEXT("Projectile hit test benchmark needs at least one player in the world"));
+			return;
+		}
+
+		// Segments start around random players so a fair share of them actually hit something
+		FRandomStream Random(1337);
+		TArray<FVector> Starts;
+		TArray<FVector> Ends;
+		Starts.Reserve(NumSegments);
+		Ends.Reserve(NumSegments);
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			const int32 SphereIndex = Random.RandHelper(Spheres.Num());
+			const FVector Center(Spheres.X[SphereIndex], Spheres.Y[SphereIndex], Spheres.Z[SphereIndex]);
+			const FVector Start = Center + Random.VRand() * Random.FRandRange(0.0f, SegmentLength * 2.0f);
+			Starts.Add(Start);
+			Ends.Add(Start + Random.VRand() * SegmentLength);
+		}
+
+		TArray<int32> AnalyticHits;
+		TArray<float> AnalyticTimes;
+		AnalyticHits.SetNumUninitialized(NumSegments);
+		AnalyticTimes.SetNumUninitialized(NumSegments);
+
+		const double AnalyticStartTime = FPlatformTime::Seconds();
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			AnalyticHits[Segment] = FFGProjectileHitTest::SegmentVsSpheres(Starts[Segment], Ends[Segment], Spheres, nullptr, AnalyticTimes[Segment]);
+		}
+		const double AnalyticTime = FPlatformTime::Seconds() - AnalyticStartTime;
+
+		int32 NumScalarMismatches = 0;
+		const double ScalarStartTime = FPlatformTime::Seconds();
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			float Time;
+			NumScalarMismatches += FFGProjectileHitTest::SegmentVsSpheresScalar(Starts[Segment], Ends[Segment], Spheres, nullptr, Time) != AnalyticHits[Segment] ? 1 : 0;
+		}
+		const double ScalarTime = FPlatformTime::Seconds() - ScalarStartTime;
+
+		TArray<FHitResult> PhysicsHits;
+		PhysicsHits.SetNum(NumSegments);
+		TArray<bool> PhysicsBlocked;
+		PhysicsBlocked.SetNumZeroed(NumSegments);
+		const FCollisionQueryParams PhysicsQueryParams(SCENE_QUERY_STAT(FGProjectileHitTestBenchmark));
+
+		const double PhysicsStartTime = FPlatformTime::Seconds();
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			PhysicsBlocked[Segment] = World->LineTraceSingleByChannel(PhysicsHits[Segment], Starts[Segment], Ends[Segment], ECC_Visibility, PhysicsQueryParams);
+		}
+		const double PhysicsTime = FPlatformTime::Seconds() - PhysicsStartTime;
+
+		// World geometry in front of a player legitimately wins in the physics path, anything else must agree
+		int32 NumHits = 0;
+		int32 NumMismatches = 0;
+		for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+		{
+			const FHitResult& Hit = PhysicsHits[Segment];
+			const AActor* PhysicsActor = PhysicsBlocked[Segment] ? Hit.GetActor() : nullptr;
+			const bool bPhysicsPlayerHit = PhysicsActor != nullptr && PhysicsActor->IsA<AFGPlayer>();
+			const AActor* AnalyticActor = AnalyticHits[Segment] != INDEX_NONE ? Spheres.Actors[AnalyticHits[Segment]] : nullptr;
+
+			bool bMatches;
+			if (bPhysicsPlayerHit)
+			{
+				bMatches = PhysicsActor == AnalyticActor && FMath::IsNearlyEqual(Hit.Time, AnalyticTimes[Segment], 0.01f);
+			}
+			else
+			{
+				bMatches = AnalyticActor == nullptr || (PhysicsBlocked[Segment] && Hit.Time <= AnalyticTimes[Segment]);
+			}
+
+			NumHits += AnalyticActor != nullptr ? 1 : 0;
+			NumMismatches += bMatches ? 0 : 1;
+		}
+
+		UE_LOG(LogFGNet, Display, TEXT("Projectile hit test: %d segments against %d players, %d hits"), NumSegments, Spheres.Num(), NumHits);
+		UE_LOG(LogFGNet, Display, TEXT("  analytic %.3f ms, scalar %.3f ms, physics %.3f ms (%.1fx faster than physics)"),
+			AnalyticTime * 1000.0, ScalarTime * 1000.0, PhysicsTime * 1000.0, PhysicsTime / FMath::Max(AnalyticTime, 1e-9));
+		UE_LOG(LogFGNet, Display, TEXT("  %d mismatches against physics, %d against scalar"), NumMismatches, NumScalarMismatches);
+	}));
+#endif // !UE_BUILD_SHIPPING
+
+#if !UE_BUILD_SHIPPING
+void UFGProjectileSubsystem::LogPoolStats() const
+{
+	// Actor plus its components, the same thing every rocket used to cost per player
+	SIZE_T PooledBytes = 0;
+	for (TActorIterator<AFGRocket> Iterator(GetWorld()); Iterator; ++Iterator)
+	{
+		if (!Iterator->bIsPooled)
+			continue;
+
+		PooledBytes += Iterator->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		for (const UActorComponent* Component : Iterator->GetComponents())
+		{
+			PooledBytes += Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+	}
+
+	UE_LOG(LogFGNet, Display, TEXT("Rocket pool: %d pooled, %d free, %d in flight, %d prewarmed (%d queued)"),
+		NumPooledRockets, FreeRockets.Num(), Rockets.Num(), NumRocketsPrewarmed, NumRocketsToPrewarm);
+	UE_LOG(LogFGNet, Display, TEXT("  %.1f KB in pooled actors, %.3f ms spent spawning them"), PooledBytes / 1024.0, PoolSpawnTime * 1000.0);
+}
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "Templates/SubclassOf.h"
+#include "FGProjectileHitTest.h"
+#include "FGProjectileSubsystem.generated.h"
+
+class AFGRocket;
+
+/**
+ * Simulates every live rocket in one tick. State is kept as structure of arrays so the movement pass only touches
+ * the data it needs, collision queries are issued back to back afterwards, and actor transforms are only written
+ * for rockets that a local player can actually see.
+ *
+ * Player collision is a single sphere per player, so hits against players are solved analytically four spheres at a
+ * time. The physics scene is only asked about world geometry, and only once a rocket gets close to the first world
+ * hit found by a long trace along its current direction.
+ *
+ * A rocket is defined entirely by its fire parameters: origin, direction and the server time it was fired at. Its
+ * location at any server time is computed from those, so late joiners and clients that lost packets land every rocket
+ * exactly where the server has it. The simulation advances in fixed steps and every step sweeps exactly the distance
+ * travelled since the previous one, so hits do not depend on the frame rate of the machine.
+ *
+ * Rocket actors come from one pool per world. They are not replicated, the server and every client keep their own
+ * pool, and a shot is identified by its shooter and shot id rather than by the actor simulating it.
+ */
+UCLASS(config = Game)
+class FGNET_API UFGProjectileSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+#pragma region FTickableGameObject
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+#pragma endregion
+
+	void AddProjectile(AFGRocket* Rocket, const FVector& StartLocation, const FVector& Direction, float FireTime, float Velocity, float LifeTime, float TargetRewindTime = 0.0f);
+	void RemoveProjectile(AFGRocket* Rocket);
+
+	// Moves a predicted rocket onto the authoritative fire parameters, the visual catches up over a few frames
+	void ApplyCorrection(AFGRocket* Rocket, const FVector& StartLocation, const FVector& Direction, float FireTime);
+
+	// Server time on the server, the game state's estimate of it on clients
+	float GetServerWorldTime() const;
+
+	int32 GetNumProjectiles() const { return Rockets.Num(); }
+
+	// Takes a free rocket of the class from the pool, spawning one if there is none
+	AFGRocket* AcquireRocket(TSubclassOf<AFGRocket> RocketClass, AActor* Shooter, int32 ShotId);
+	// Stops simulating the rocket and returns it to the pool
+	void ReleaseRocket(AFGRocket* Rocket);
+	// Called when a rocket actor is destroyed, pooled or not
+	void ForgetRocket(AFGRocket* Rocket);
+
+	// Queues rockets to be spawned into the pool a few per frame, so joining does not pay for them in one hitch
+	void PrewarmPool(TSubclassOf<AFGRocket> RocketClass, int32 NumRockets);
+
+	AFGRocket* FindRocket(const AActor* Shooter, int32 ShotId) const;
+	int32 GetNumActiveRockets(const AActor* Shooter) const;
+
+	int32 GetNumPooledRockets() const { return NumPooledRockets; }
+	int32 GetNumFreeRockets() const { return FreeRockets.Num(); }
+
+#if !UE_BUILD_SHIPPING
+	void LogPoolStats() const;
+#endif // !UE_BUILD_SHIPPING
+
+	// Free rockets above this count are destroyed once they have been idle for PoolShrinkDelay
+	UPROPERTY(Config)
+	int32 MinPooledRockets = 8;
+
+	UPROPERTY(Config)
+	float PoolShrinkDelay = 30.0f;
+
+	// Prewarming never queues more rockets than this in total
+	UPROPERTY(Config)
+	int32 MaxPrewarmedRockets = 64;
+
+	UPROPERTY(Config)
+	int32 PrewarmSpawnsPerFrame = 2;
+
+	// Fixed simulation steps per second, at zero the simulation follows the frame delta time instead
+	UPROPERTY(Config)
+	float SimulationRate = 60.0f;
+
+	// Most steps a single frame will run, time beyond that is dropped
+	static constexpr int32 MaxStepsPerFrame = 8;
+
+	// How quickly the visual offset left behind by a correction is removed
+	UPROPERTY(Config)
+	float CorrectionSmoothingSpeed = 8.0f;
+
+	// Rockets further away from every local view than this are not moved visually
+	UPROPERTY(Config)
+	float VisualCullDistance = 20000.0f;
+
+	// Hidden rockets still get their actor moved this often, so relevancy and spatial queries stay roughly correct
+	UPROPERTY(Config)
+	float HiddenTransformUpdateInterval = 0.25f;
+
+	// Solve hits against player spheres analytically instead of tracing everything through the physics scene
+	UPROPERTY(Config)
+	bool bUseAnalyticHitTest = true;
+
+	// The long world trace is redone after the rocket travelled this far even if the direction has not changed, in case
+	// something moved in the way. Never more than WorldTraceMargin, or a rocket could pass something that moved in between two traces
+	UPROPERTY(Config)
+	float WorldTraceRefreshDistance = 200.0f;
+
+	// A rocket this close to its cached world hit traces against world geometry every frame
+	UPROPERTY(Config)
+	float WorldTraceMargin = 200.0f;
+
+	// On the server, a rocket that misses every player also tests them where its shooter saw them when firing
+	UPROPERTY(Config)
+	bool bRewindTargets = true;
+
+	void GatherPlayerSpheres(FFGHitSpheres& OutSpheres) const;
+
+private:
+	struct FFGProjectileView
+	{
+		FVector Location;
+		FVector Direction;
+		float CosHalfFOV;
+	};
+
+	struct FFGProjectileEvent
+	{
+		AFGRocket* Rocket;
+		FVector Location;
+		AActor* HitActor;
+	};
+
+	void TickPool();
+	AFGRocket* SpawnPooledRocket(TSubclassOf<AFGRocket> RocketClass);
+	// Every rocket is placed from its fire parameters at ServerTime, so the step needs no length of its own
+	void SimulateStep(float ServerTime);
+	void UpdateVisuals(float DeltaTime, float InterpolationAlpha);
+	void RemoveAtSwap(int32 Index);
+	void GatherLocalViews();
+	bool IsVisibleToLocalView(const FVector& Location) const;
+	bool IsNearWorldGeometry(int32 Index);
+	AActor* FindRewoundHit(int32 Index, const FVector& StartLocation, const FVector& EndLocation, float ServerTime, float& OutTime);
+
+	TArray<AFGRocket*> Rockets;
+	TArray<FVector> StartLocations;
+	TArray<FVector> Directions;
+	TArray<FVector> OriginalDirections;
+	TArray<float> FireTimes;
+	// How far the shooter's view of the other players was behind FireTimes, per shot since every shot has its own latency
+	TArray<float> TargetRewindTimes;
+	TArray<FVector> Locations;
+	TArray<FVector> PreviousLocations;
+	TArray<float> DistancesMoved;
+	TArray<float> Velocities;
+	TArray<float> LifeTimes;
+	TArray<float> LifeTimesRemaining;
+	TArray<FVector> VisualOffsets;
+	TArray<bool> VisualsVisible;
+
+	// Distance moved at which the rocket reaches the first world hit along WorldTraceDirections
+	TArray<float> WorldHitDistances;
+	TArray<FVector> WorldTraceDirections;
+	// Distance moved when the long world trace was last done
+	TArray<float> WorldTraceDistances;
+
+	TArray<FFGProjectileView> LocalViews;
+	TArray<FFGProjectileEvent> PendingEvents;
+
+	// Oldest released first, so the front of the array is what the pool shrinks away
+	UPROPERTY(Transient)
+	TArray<AFGRocket*> FreeRockets;
+	TArray<float> FreeRocketReleaseTimes;
+
+	UPROPERTY(Transient)
+	TSubclassOf<AFGRocket> PrewarmClass;
+	int32 NumRocketsToPrewarm = 0;
+	int32 NumRocketsPrewarmed = 0;
+	int32 NumPooledRockets = 0;
+	double PoolSpawnTime = 0.0;
+
+	FFGHitSpheres PlayerSpheres;
+	FFGHitSpheres RewoundSpheres;
+	FCollisionQueryParams WorldQueryParams;
+
+	float HiddenTransformUpdateTimer = 0.0f;
+	float StepAccumulator = 0.0f;
+	float LastStepServerTime = 0.0f;
+};
@@ -0,0 +1,157 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "../FGNetQuantization.h"
+#include "../Player/FGPlayer.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFGNetQuantizationTest, "FGNet.Quantization", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFGNetQuantizationTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(1337);
+	const FBox Bounds(FVector(-20000.0f, -20000.0f, -1000.0f), FVector(20000.0f, 20000.0f, 5000.0f));
+
+	// Locations come back within half a step, using exactly the number of bits the bounds need
+	for (const float Precision : { 0.1f, 0.5f, 1.0f, 4.0f })
+	{
+		const FFGNetQuantization Quantization(Bounds, Precision);
+		const int32 NumLocationBits = Quantization.GetLocationBits(0) + Quantization.GetLocationBits(1) + Quantization.GetLocationBits(2);
+
+		TArray<FVector> Locations = { Bounds.Min, Bounds.Max, Bounds.GetCenter() };
+		for (int32 Index = 0; Index < 1000; ++Index)
+		{
+			Locations.Add(Random.RandPointInBox(Bounds));
+		}
+
+		float WorstError = 0.0f;
+		for (const FVector& Location : Locations)
+		{
+			FIntVector Quantized;
+			if (!TestTrue(TEXT("Location inside the bounds is quantized"), Quantization.QuantizeLocation(Location, Quantized)))
+				return false;
+
+			FBitWriter Writer(0, true);
+			Quantization.SerializeQuantizedLocation(Writer, Quantized);
+			TestEqual(TEXT("Location bits"), static_cast<int32>(Writer.GetNumBits()), NumLocationBits);
+
+			FIntVector ReadQuantized;
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			Quantization.SerializeQuantizedLocation(Reader, ReadQuantized);
+			TestFalse(TEXT("Location read error"), Reader.IsError());
+
+			const FVector Delta = (Quantization.DequantizeLocation(ReadQuantized) - Location).GetAbs();
+			WorstError = FMath::Max(WorstError, Delta.GetMax());
+		}
+
+		TestTrue(FString::Printf(TEXT("Worst location error %f at precision %f"), WorstError, Precision), WorstError <= Precision * 0.5f + 0.01f);
+
+		FIntVector Quantized;
+		TestFalse(TEXT("Location outside the bounds is not quantized"), Quantization.QuantizeLocation(Bounds.Max + FVector(Precision * 2.0f), Quantized));
+	}
+
+	// Forward input comes back within half a step and keeps -1, 0 and 1 exact
+	for (const int32 NumBits : { FGNetMovement::NetForwardBits, 8, 12 })
+	{
+		const float MaxError = 0.5f / ((1 << (NumBits - 1)) - 1);
+
+		float WorstError = 0.0f;
+		for (int32 Step = -1000; Step <= 1000; ++Step)
+		{
+			const float Forward = Step / 1000.0f;
+
+			FBitWriter Writer(0, true);
+			float WrittenForward = Forward;
+			FFGNetQuantization::SerializeSignedUnitFloat(Writer, WrittenForward, NumBits);
+			TestEqual(TEXT("Forward bits"), static_cast<int32>(Writer.GetNumBits()), NumBits);
+
+			float ReadForward = 0.0f;
+			FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+			FFGNetQuantization::SerializeSignedUnitFloat(Reader, ReadForward, NumBits);
+
+			WorstError = FMath::Max(WorstError, FMath::Abs(ReadForward - Forward));
+			if (Step == -1000 || Step == 0 || Step == 1000)
+			{
+				TestEqual(TEXT("Forward extremes are exact"), ReadForward, Forward);
+			}
+		}
+
+		TestTrue(FString::Printf(TEXT("Worst forward error %f with %d bits"), WorstError, NumBits), WorstError <= MaxError + KINDA_SMALL_NUMBER);
+	}
+
+	// Time comes back modulo the 16 bit millisecond clock, and deltas stay correct across the wrap
+	const float WrapTime = 65.536f;
+	for (const float Time : { 0.0f, 0.0004f, 12.3456f, WrapTime - 0.001f, WrapTime, WrapTime + 0.25f, 300.1234f })
+	{
+		FBitWriter Writer(0, true);
+		float WrittenTime = Time;
+		FFGNetQuantization::SerializeWrappedTime(Writer, WrittenTime);
+		TestEqual(TEXT("Time bits"), static_cast<int32>(Writer.GetNumBits()), 16);
+
+		float ReadTime = -1.0f;
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		FFGNetQuantization::SerializeWrappedTime(Reader, ReadTime);
+
+		TestTrue(TEXT("Wrapped time is below the wrap"), ReadTime >= 0.0f && ReadTime < WrapTime);
+		TestTrue(FString::Printf(TEXT("Wrapped time %f round trips %f"), ReadTime, Time), FMath::Abs(FFGNetQuantization::GetWrappedTimeDelta(ReadTime, Time)) <= 0.0005f + KINDA_SMALL_NUMBER);
+	}
+
+	TestEqual(TEXT("Delta across the wrap"), FFGNetQuantization::GetWrappedTimeDelta(WrapTime + 0.05f, WrapTime - 0.05f), 0.1f, 0.0011f);
+	TestEqual(TEXT("Delta from a wrapped value"), FFGNetQuantization::GetWrappedTimeDelta(0.05f, WrapTime - 0.05f), 0.1f, 0.0011f);
+	TestEqual(TEXT("Negative delta across the wrap"), FFGNetQuantization::GetWrappedTimeDelta(WrapTime - 0.05f, 0.05f), -0.1f, 0.0011f);
+	TestEqual(TEXT("Largest forward delta"), FFGNetQuantization::GetWrappedTimeDelta(100.0f + 32.767f, 100.0f), 32.767f, 0.0011f);
+	TestTrue(TEXT("Deltas over half the clock alias backwards"), FFGNetQuantization::GetWrappedTimeDelta(100.0f + 32.769f, 100.0f) < 0.0f);
+
+	// A batch with an unquantized sample in the middle, which restarts the delta chain after it
+	{
+		const FFGNetQuantization Quantization(Bounds, 1.0f);
+
+		FFGNetMovementBatch Batch;
+		FVector Location = Bounds.GetCenter();
+		for (uint32 Index = 0; Index < FFGNetMovementBatch::MaxMovements; ++Index)
+		{
+			Location += Random.VRand() * Random.FRandRange(0.0f, 200.0f);
+
+			FGNetMovement& Movement = Batch.Movements.AddDefaulted_GetRef();
+			Movement.NetLocation = Index == FFGNetMovementBatch::MaxMovements / 2 ? Bounds.Max + FVector(1000.5f) : Location;
+			Movement.NetForward = Random.FRandRange(-1.0f, 1.0f);
+			Movement.NetYaw = static_cast<uint8>(Random.RandHelper(256));
+			Movement.NetTime = WrapTime - 0.1f + Index / 60.0f;
+		}
+
+		FBitWriter Writer(0, true);
+		Batch.SerializeQuantized(Writer, Quantization);
+
+		FFGNetMovementBatch ReadBatch;
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		ReadBatch.SerializeQuantized(Reader, Quantization);
+		TestFalse(TEXT("Batch read error"), Reader.IsError());
+		TestTrue(TEXT("Batch read every bit"), Reader.AtEnd());
+
+		if (!TestEqual(TEXT("Batch size"), ReadBatch.Movements.Num(), Batch.Movements.Num()))
+			return false;
+
+		const float MaxForwardError = 0.5f / ((1 << (FGNetMovement::NetForwardBits - 1)) - 1);
+		for (int32 Index = 0; Index < Batch.Movements.Num(); ++Index)
+		{
+			const FGNetMovement& Movement = Batch.Movements[Index];
+			const FGNetMovement& ReadMovement = ReadBatch.Movements[Index];
+
+			TestTrue(FString::Printf(TEXT("Batch location %d"), Index), (ReadMovement.NetLocation - Movement.NetLocation).GetAbs().GetMax() <= 0.51f);
+			TestTrue(FString::Printf(TEXT("Batch forward %d"), Index), FMath::Abs(ReadMovement.NetForward - Movement.NetForward) <= MaxForwardError + KINDA_SMALL_NUMBER);
+			TestEqual(FString::Printf(TEXT("Batch yaw %d"), Index), ReadMovement.NetYaw, Movement.NetYaw);
+			TestTrue(FString::Printf(TEXT("Batch time %d"), Index), FMath::Abs(FFGNetQuantization::GetWrappedTimeDelta(ReadMovement.NetTime, Movement.NetTime)) <= 0.0005f + KINDA_SMALL_NUMBER);
+		}
+	}
+
+	TestTrue(TEXT("Worlds without settings use the default bounds"), &FFGNetQuantization::Get(static_cast<const UWorld*>(nullptr)) == &FFGNetQuantization::GetDefault());
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
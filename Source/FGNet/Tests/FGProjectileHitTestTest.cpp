@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "../Projectile/FGProjectileHitTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace FGProjectileHitTestTest
+{
+	// The hit test only compares actor pointers, so these stand in for actors and are never dereferenced
+	static uint8 FakeActors[16];
+	static AActor* GetFakeActor(int32 Index) { return reinterpret_cast<AActor*>(&FakeActors[Index]); }
+
+	// Engine line vs sphere query, extended with the starts inside case which FMath::LineSphereIntersection does not report
+	static bool LineTraceSphere(const FVector& Start, const FVector& End, const FVector& Center, float Radius)
+	{
+		if (FVector::DistSquared(Start, Center) <= FMath::Square(Radius))
+			return true;
+
+		const FVector Delta = End - Start;
+		const float Length = Delta.Size();
+		return Length > SMALL_NUMBER && FMath::LineSphereIntersection(Start, Delta / Length, Length, Center, Radius);
+	}
+
+	// Segment fraction at which a double precision trace enters the sphere, false when it does not
+	static bool GetReferenceTime(const FVector& Start, const FVector& End, const FVector& Center, float Radius, double& OutTime, bool& bOutAmbiguous)
+	{
+		const double DeltaX = End.X - Start.X, DeltaY = End.Y - Start.Y, DeltaZ = End.Z - Start.Z;
+		const double MX = Start.X - Center.X, MY = Start.Y - Center.Y, MZ = Start.Z - Center.Z;
+		const double A = DeltaX * DeltaX + DeltaY * DeltaY + DeltaZ * DeltaZ;
+		const double B = MX * DeltaX + MY * DeltaY + MZ * DeltaZ;
+		const double C = MX * MX + MY * MY + MZ * MZ - double(Radius) * Radius;
+
+		// Close enough to a tangent, an end point or the surface that float rounding may decide either way
+		const double Tolerance = 1e-3 * Radius;
+		const double Discriminant = B * B - A * C;
+		const double LineDistance = sqrt(FMath::Max(C + double(Radius) * Radius - B * B / A, 0.0));
+		bOutAmbiguous |= FMath::Abs(LineDistance - Radius) < Tolerance || FMath::Abs(sqrt(C + double(Radius) * Radius) - Radius) < Tolerance;
+
+		if (C <= 0.0)
+		{
+			OutTime = 0.0;
+			return true;
+		}
+
+		if (Discriminant < 0.0)
+			return false;
+
+		OutTime = (-B - sqrt(Discriminant)) / A;
+		bOutAmbiguous |= FMath::Abs(OutTime) * sqrt(A) < Tolerance || FMath::Abs(OutTime - 1.0) * sqrt(A) < Tolerance;
+		return OutTime >= 0.0 && OutTime <= 1.0;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFGProjectileHitTestTest, "FGNet.Projectile.HitTest", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFGProjectileHitTestTest::RunTest(const FString& Parameters)
+{
+	using namespace FGProjectileHitTestTest;
+
+	const float Radius = 50.0f;
+	FFGHitSpheres Spheres;
+	float Time;
+	float ScalarTime;
+
+	// Tangent: just inside the radius hits, just outside misses
+	Spheres.Add(FVector::ZeroVector, Radius, GetFakeActor(0));
+	for (const float Offset : { Radius * 0.999f, Radius * 1.001f })
+	{
+		const FVector Start(-200.0f, Offset, 0.0f);
+		const FVector End(200.0f, Offset, 0.0f);
+		const bool bExpectHit = Offset < Radius;
+
+		TestTrue(FString::Printf(TEXT("Tangent at %f"), Offset), (FFGProjectileHitTest::SegmentVsSpheres(Start, End, Spheres, nullptr, Time) != INDEX_NONE) == bExpectHit);
+		TestTrue(FString::Printf(TEXT("Scalar tangent at %f"), Offset), (FFGProjectileHitTest::SegmentVsSpheresScalar(Start, End, Spheres, nullptr, ScalarTime) != INDEX_NONE) == bExpectHit);
+		TestTrue(FString::Printf(TEXT("Line trace tangent at %f"), Offset), LineTraceSphere(Start, End, FVector::ZeroVector, Radius) == bExpectHit);
+	}
+
+	// Starting inside hits at the very start of the segment
+	TestEqual(TEXT("Inside"), FFGProjectileHitTest::SegmentVsSpheres(FVector(10.0f, 0.0f, 0.0f), FVector(500.0f, 0.0f, 0.0f), Spheres, nullptr, Time), 0);
+	TestEqual(TEXT("Inside time"), Time, 0.0f);
+	TestEqual(TEXT("Scalar inside"), FFGProjectileHitTest::SegmentVsSpheresScalar(FVector(10.0f, 0.0f, 0.0f), FVector(500.0f, 0.0f, 0.0f), Spheres, nullptr, ScalarTime), 0);
+	TestEqual(TEXT("Scalar inside time"), ScalarTime, 0.0f);
+
+	// A rocket that did not move this step does not hit anything, even from inside a sphere, like a zero length line trace
+	TestEqual(TEXT("Zero length"), FFGProjectileHitTest::SegmentVsSpheres(FVector(10.0f, 0.0f, 0.0f), FVector(10.0f, 0.0f, 0.0f), Spheres, nullptr, Time), static_cast<int32>(INDEX_NONE));
+	TestEqual(TEXT("Scalar zero length"), FFGProjectileHitTest::SegmentVsSpheresScalar(FVector(10.0f, 0.0f, 0.0f), FVector(10.0f, 0.0f, 0.0f), Spheres, nullptr, ScalarTime), static_cast<int32>(INDEX_NONE));
+
+	TestEqual(TEXT("Ignored actor"), FFGProjectileHitTest::SegmentVsSpheres(FVector(-200.0f, 0.0f, 0.0f), FVector(200.0f, 0.0f, 0.0f), Spheres, GetFakeActor(0), Time), static_cast<int32>(INDEX_NONE));
+
+	// Padding lanes are zero sized spheres at the origin, a segment starting there must not hit them
+	Spheres.Reset();
+	for (int32 Index = 0; Index < 5; ++Index)
+	{
+		Spheres.Add(FVector(1000.0f + Index * 200.0f, 0.0f, 0.0f), Radius, GetFakeActor(Index));
+	}
+	TestEqual(TEXT("Padding lanes"), FFGProjectileHitTest::SegmentVsSpheres(FVector::ZeroVector, FVector(0.0f, 500.0f, 0.0f), Spheres, nullptr, Time), static_cast<int32>(INDEX_NONE));
+	TestEqual(TEXT("Nearest of several"), FFGProjectileHitTest::SegmentVsSpheres(FVector(2000.0f, 0.0f, 0.0f), FVector(0.0f, 0.0f, 0.0f), Spheres, nullptr, Time), 4);
+
+	// Randomized segments against a handful of spheres, step sized and longer, compared to a double precision trace
+	FRandomStream Random(1337);
+	const FBox SphereBox(FVector(-300.0f), FVector(300.0f));
+	const FBox StartBox(FVector(-400.0f), FVector(400.0f));
+	int32 NumCompared = 0;
+	int32 NumHits = 0;
+	for (int32 Iteration = 0; Iteration < 20000; ++Iteration)
+	{
+		const int32 NumSpheres = 1 + Random.RandHelper(UE_ARRAY_COUNT(FakeActors));
+		TArray<FVector> Centers;
+		TArray<float> Radii;
+
+		Spheres.Reset();
+		for (int32 Index = 0; Index < NumSpheres; ++Index)
+		{
+			Centers.Add(Random.RandPointInBox(SphereBox));
+			Radii.Add(Random.FRandRange(20.0f, 150.0f));
+			Spheres.Add(Centers[Index], Radii[Index], GetFakeActor(Index));
+		}
+
+		const FVector Start = Random.RandPointInBox(StartBox);
+		const FVector End = Start + Random.VRand() * (Random.RandHelper(2) == 0 ? Random.FRandRange(1.0f, 50.0f) : Random.FRandRange(50.0f, 3000.0f));
+		AActor* IgnoredActor = Random.RandHelper(4) == 0 ? GetFakeActor(Random.RandHelper(NumSpheres)) : nullptr;
+
+		bool bAmbiguous = false;
+		int32 ExpectedIndex = INDEX_NONE;
+		double ExpectedTime = MAX_dbl;
+		double SecondTime = MAX_dbl;
+		for (int32 Index = 0; Index < NumSpheres; ++Index)
+		{
+			double SphereTime;
+			const bool bHit = GetReferenceTime(Start, End, Centers[Index], Radii[Index], SphereTime, bAmbiguous);
+			if (bHit != LineTraceSphere(Start, End, Centers[Index], Radii[Index]))
+			{
+				bAmbiguous = true;
+			}
+
+			if (!bHit || GetFakeActor(Index) == IgnoredActor)
+				continue;
+
+			if (SphereTime < ExpectedTime)
+			{
+				SecondTime = ExpectedTime;
+				ExpectedTime = SphereTime;
+				ExpectedIndex = Index;
+			}
+			else
+			{
+				SecondTime = FMath::Min(SecondTime, SphereTime);
+			}
+		}
+
+		// Two spheres entered at practically the same point can come out in either order
+		bAmbiguous |= SecondTime != MAX_dbl && (SecondTime - ExpectedTime) * (End - Start).Size() < 0.1;
+		if (bAmbiguous)
+			continue;
+
+		NumCompared++;
+		NumHits += ExpectedIndex != INDEX_NONE ? 1 : 0;
+
+		const int32 HitIndex = FFGProjectileHitTest::SegmentVsSpheres(Start, End, Spheres, IgnoredActor, Time);
+		const int32 ScalarHitIndex = FFGProjectileHitTest::SegmentVsSpheresScalar(Start, End, Spheres, IgnoredActor, ScalarTime);
+		if (!TestEqual(FString::Printf(TEXT("Random segment %d"), Iteration), HitIndex, ExpectedIndex) || !TestEqual(FString::Printf(TEXT("Scalar random segment %d"), Iteration), ScalarHitIndex, ExpectedIndex))
+			return false;
+
+		// Compared as a distance along the segment, which is what decides where the rocket explodes
+		if (ExpectedIndex != INDEX_NONE)
+		{
+			const float Length = (End - Start).Size();
+			TestEqual(FString::Printf(TEXT("Random segment %d hit distance"), Iteration), Time * Length, static_cast<float>(ExpectedTime * Length), 0.05f);
+			TestEqual(FString::Printf(TEXT("Scalar random segment %d hit distance"), Iteration), ScalarTime * Length, static_cast<float>(ExpectedTime * Length), 0.05f);
+		}
+	}
+
+	AddInfo(FString::Printf(TEXT("Compared %d random segments, %d of them hit"), NumCompared, NumHits));
+	TestTrue(TEXT("Most random segments are unambiguous"), NumCompared > 19000);
+	TestTrue(TEXT("Random segments cover hits and misses"), NumHits > 1000 && NumHits < NumCompared - 1000);
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "Math/RandomStream.h"
+#include "../FGTimerWheel.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FFGTimerWheelTest, "FGNet.TimerWheel", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FFGTimerWheelTest::RunTest(const FString& Parameters)
+{
+	FRandomStream Random(1337);
+	const float TickInterval = 0.05f;
+	// Float rounding of the tick boundaries, far below anything a caller could notice
+	const double Epsilon = 1e-4;
+
+	// 20000 timers set before and while running, with frame times around and above the tick interval and some cleared early
+	{
+		const int32 NumTimers = 20000;
+		const int32 NumInitialTimers = NumTimers / 2;
+		const int32 TimersPerFrame = 50;
+
+		FFGTimerWheel TimerWheel(TickInterval);
+		TArray<FFGTimerWheelHandle> Handles;
+		TArray<double> ExpectedTimes;
+		TArray<double> FireTimes;
+		TArray<int32> ClearFrames;
+		TArray<bool> Cleared;
+		double Now = 0.0;
+		float FrameDelta = 0.0f;
+		int32 NumEarly = 0;
+		int32 NumLate = 0;
+		int32 NumFiredTwice = 0;
+		int32 NumClearedFired = 0;
+
+		auto SetTimer = [&](int32 Frame)
+		{
+			const int32 Index = Handles.Num();
+			const float Delay = Random.FRandRange(0.0f, 10.0f);
+			Handles.Add(TimerWheel.SetTimer(FSimpleDelegate::CreateLambda([&, Index]()
+			{
+				NumFiredTwice += FireTimes[Index] >= 0.0 ? 1 : 0;
+				NumClearedFired += Cleared[Index] ? 1 : 0;
+				NumEarly += Now < ExpectedTimes[Index] - Epsilon ? 1 : 0;
+				NumLate += Now > ExpectedTimes[Index] + TickInterval + FrameDelta + Epsilon ? 1 : 0;
+				FireTimes[Index] = Now;
+			}), Delay));
+
+			ExpectedTimes.Add(Now + Delay);
+			FireTimes.Add(-1.0);
+			Cleared.Add(false);
+			// One in five is cleared somewhere between being set and around when it is due
+			ClearFrames.Add(Random.RandHelper(5) == 0 ? Frame + Random.RandHelper(FMath::CeilToInt(Delay * 30.0f) + 2) : INDEX_NONE);
+		};
+
+		for (int32 Index = 0; Index < NumInitialTimers; ++Index)
+		{
+			SetTimer(0);
+		}
+
+		int32 Frame = 0;
+		while (Handles.Num() < NumTimers || TimerWheel.GetNumTimers() > 0)
+		{
+			Frame++;
+			FrameDelta = Random.RandHelper(50) == 0 ? 0.25f : Random.FRandRange(1.0f / 144.0f, 1.0f / 20.0f);
+			Now += FrameDelta;
+			TimerWheel.Advance(FrameDelta);
+
+			for (int32 Index = 0; Index < Handles.Num(); ++Index)
+			{
+				if (ClearFrames[Index] == Frame)
+				{
+					// Clearing a timer that already fired is allowed and does nothing
+					Cleared[Index] = FireTimes[Index] < 0.0;
+					TimerWheel.ClearTimer(Handles[Index]);
+					TestFalse(TEXT("Cleared timer is inactive"), TimerWheel.IsTimerActive(Handles[Index]));
+				}
+			}
+
+			for (int32 Count = 0; Count < TimersPerFrame && Handles.Num() < NumTimers; ++Count)
+			{
+				SetTimer(Frame);
+			}
+
+			if (!TestTrue(TEXT("Timers finish"), Frame < 100000))
+				return false;
+		}
+
+		int32 NumCleared = 0;
+		int32 NumNeverFired = 0;
+		for (int32 Index = 0; Index < NumTimers; ++Index)
+		{
+			NumCleared += Cleared[Index] ? 1 : 0;
+			NumNeverFired += !Cleared[Index] && FireTimes[Index] < 0.0 ? 1 : 0;
+		}
+
+		AddInfo(FString::Printf(TEXT("%d timers over %d frames, %d cleared before firing"), NumTimers, Frame, NumCleared));
+		TestEqual(TEXT("Timers fired early"), NumEarly, 0);
+		TestEqual(TEXT("Timers fired more than a tick late"), NumLate, 0);
+		TestEqual(TEXT("Timers fired twice"), NumFiredTwice, 0);
+		TestEqual(TEXT("Cleared timers fired"), NumClearedFired, 0);
+		TestEqual(TEXT("Timers never fired"), NumNeverFired, 0);
+		TestTrue(TEXT("Some timers were cleared"), NumCleared > NumTimers / 10);
+		TestEqual(TEXT("Nothing left in the wheel"), TimerWheel.GetNumExpiredTimers(), 0);
+	}
+
+	// Timers expiring together fire at most MaxFiresPerAdvance per call, in the order they were set
+	{
+		const int32 NumTimers = 1000;
+		const int32 MaxFiresPerAdvance = 256;
+
+		FFGTimerWheel TimerWheel(TickInterval);
+		TArray<int32> FireOrder;
+		for (int32 Index = 0; Index < NumTimers; ++Index)
+		{
+			TimerWheel.SetTimer(FSimpleDelegate::CreateLambda([&FireOrder, Index]() { FireOrder.Add(Index); }), 0.075f);
+		}
+
+		TestEqual(TEXT("Nothing due before the delay"), TimerWheel.Advance(0.06f, MaxFiresPerAdvance), 0);
+
+		int32 NumAdvances = 0;
+		while (TimerWheel.GetNumTimers() > 0 && NumAdvances < 100)
+		{
+			const int32 ExpectedFires = FMath::Min(TimerWheel.GetNumTimers(), MaxFiresPerAdvance);
+			const int32 NumFired = TimerWheel.Advance(TickInterval, MaxFiresPerAdvance);
+			TestEqual(FString::Printf(TEXT("Fires in advance %d"), NumAdvances), NumFired, ExpectedFires);
+			TestEqual(TEXT("Timers left queued"), TimerWheel.GetNumExpiredTimers(), TimerWheel.GetNumTimers());
+			NumAdvances++;
+		}
+
+		TestEqual(TEXT("Advances to fire everything"), NumAdvances, FMath::DivideAndRoundUp(NumTimers, MaxFiresPerAdvance));
+		if (TestEqual(TEXT("Fired timers"), FireOrder.Num(), NumTimers))
+		{
+			for (int32 Index = 0; Index < NumTimers; ++Index)
+			{
+				if (!TestEqual(TEXT("Fire order"), FireOrder[Index], Index))
+					break;
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS